@@ -0,0 +1,71 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "async.h"
+
+namespace badgerdb {
+
+IoEventLoop::IoEventLoop(const std::size_t numThreads)
+    : stopping(false) {
+  for (std::size_t i = 0; i < (numThreads == 0 ? 1 : numThreads); i++) {
+    ioThreads.push_back(std::thread(&IoEventLoop::ioLoop, this));
+  }
+}
+
+IoEventLoop::~IoEventLoop() {
+  {
+    std::lock_guard<std::mutex> guard(latch);
+    stopping = true;
+  }
+  workReady.notify_all();
+  for (std::size_t i = 0; i < ioThreads.size(); i++) {
+    ioThreads[i].join();
+  }
+}
+
+void IoEventLoop::submit(std::function<void()> io, std::coroutine_handle<> then) {
+  {
+    std::lock_guard<std::mutex> guard(latch);
+    work.push_back(std::make_pair(std::move(io), then));
+  }
+  workReady.notify_one();
+}
+
+std::size_t IoEventLoop::runOnce() {
+  std::deque<std::coroutine_handle<> > resuming;
+  {
+    std::unique_lock<std::mutex> guard(latch);
+    resumeReady.wait(guard, [this]() { return !ready.empty(); });
+    resuming.swap(ready);
+  }
+  // resumed without the latch, since a coroutine may submit more work before it suspends again
+  for (std::size_t i = 0; i < resuming.size(); i++) {
+    resuming[i].resume();
+  }
+  return resuming.size();
+}
+
+void IoEventLoop::ioLoop() {
+  std::unique_lock<std::mutex> guard(latch);
+  for (;;) {
+    workReady.wait(guard, [this]() { return stopping || !work.empty(); });
+    if (stopping) {
+      return;
+    }
+    std::pair<std::function<void()>, std::coroutine_handle<> > next = std::move(work.front());
+    work.pop_front();
+    guard.unlock();
+
+    next.first();
+
+    guard.lock();
+    ready.push_back(next.second);
+    resumeReady.notify_one();
+  }
+}
+
+}
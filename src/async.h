@@ -0,0 +1,346 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace badgerdb {
+
+/**
+ * @brief Where the asynchronous calls of BufMgr do the work that blocks, and where the coroutines
+ *        waiting on it are resumed.
+ *
+ * The caller supplies the loop. submit() must run io on a thread that is allowed to block, such as
+ * one of a few I/O threads sized to the disk rather than to the number of requests, and then
+ * resume the coroutine on whichever thread drives the loop. Resuming it on the I/O thread itself
+ * is allowed too, at the cost of running the rest of the coroutine there.
+ */
+class EventLoop {
+ public:
+  /**
+   * Destructor of EventLoop class
+   */
+  virtual ~EventLoop() {}
+
+  /**
+   * Runs io, then resumes then. Exceptions thrown by io are the caller's to catch; the loop must
+   * not let one escape.
+   *
+   * @param io      Work that may block
+   * @param then    Coroutine suspended until io is done
+   */
+  virtual void submit(std::function<void()> io, std::coroutine_handle<> then) = 0;
+};
+
+template <typename T>
+class Task;
+
+namespace detail {
+
+/**
+ * Promise state every Task shares: the coroutine awaiting it and what it threw
+ */
+struct TaskPromiseBase {
+  std::coroutine_handle<> continuation;
+  std::exception_ptr failure;
+
+  /**
+   * Resumes the awaiting coroutine, if any, without growing the stack
+   */
+  struct FinalAwaiter {
+    bool await_ready() const noexcept { return false; }
+
+    template <typename Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> finished) noexcept {
+      const std::coroutine_handle<> next = finished.promise().continuation;
+      return next ? next : std::noop_coroutine();
+    }
+
+    void await_resume() const noexcept {}
+  };
+
+  std::suspend_always initial_suspend() const noexcept { return {}; }
+  FinalAwaiter final_suspend() const noexcept { return {}; }
+  void unhandled_exception() { failure = std::current_exception(); }
+};
+
+template <typename T>
+struct TaskPromise : TaskPromiseBase {
+  std::optional<T> value;
+
+  Task<T> get_return_object();
+  void return_value(T result) { value.emplace(std::move(result)); }
+
+  T result() {
+    if (failure) {
+      std::rethrow_exception(failure);
+    }
+    return std::move(*value);
+  }
+};
+
+template <>
+struct TaskPromise<void> : TaskPromiseBase {
+  Task<void> get_return_object();
+  void return_void() const noexcept {}
+
+  void result() {
+    if (failure) {
+      std::rethrow_exception(failure);
+    }
+  }
+};
+
+}
+
+/**
+ * @brief Coroutine returned by the asynchronous calls of BufMgr.
+ *
+ * A task does nothing until it is awaited with co_await, or started with start() by code that is
+ * not a coroutine, such as an event loop. Awaiting it gives its result or rethrows what it threw.
+ * Tasks can be moved but not copied, and destroy their coroutine when they go away, so a task
+ * must outlive its own completion.
+ */
+template <typename T>
+class Task {
+ public:
+  typedef detail::TaskPromise<T> promise_type;
+
+  /**
+   * Constructs a task that holds no coroutine.
+   */
+  Task() : coroutine(nullptr) {}
+
+  /**
+   * Takes over the coroutine of other, which is left empty.
+   */
+  Task(Task&& other) noexcept : coroutine(std::exchange(other.coroutine, nullptr)) {}
+
+  /**
+   * Destroys the coroutine held, then takes over the coroutine of other.
+   */
+  Task& operator=(Task&& other) noexcept {
+    if (this != &other) {
+      if (coroutine) {
+        coroutine.destroy();
+      }
+      coroutine = std::exchange(other.coroutine, nullptr);
+    }
+    return *this;
+  }
+
+  Task(const Task&) = delete;
+  Task& operator=(const Task&) = delete;
+
+  /**
+   * Destructor of Task class
+   */
+  ~Task() {
+    if (coroutine) {
+      coroutine.destroy();
+    }
+  }
+
+  /**
+   * Runs the task up to its first suspension, for callers that are not coroutines.
+   */
+  void start() { coroutine.resume(); }
+
+  /**
+   * True once the task has returned or thrown
+   */
+  bool done() const { return coroutine.done(); }
+
+  /**
+   * Result of a task that is done, or what it threw.
+   */
+  T result() { return coroutine.promise().result(); }
+
+  bool await_ready() const noexcept { return coroutine.done(); }
+
+  std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+    coroutine.promise().continuation = awaiting;
+    return coroutine;
+  }
+
+  T await_resume() { return coroutine.promise().result(); }
+
+ private:
+  explicit Task(std::coroutine_handle<promise_type> handle) : coroutine(handle) {}
+
+  /**
+   * The task's coroutine, suspended at its start until started or awaited
+   */
+  std::coroutine_handle<promise_type> coroutine;
+
+  friend struct detail::TaskPromise<T>;
+};
+
+namespace detail {
+
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object() {
+  return Task<T>(std::coroutine_handle<TaskPromise<T> >::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() {
+  return Task<void>(std::coroutine_handle<TaskPromise<void> >::from_promise(*this));
+}
+
+}
+
+/**
+ * @brief Awaitable that suspends a coroutine while work that blocks runs through an EventLoop.
+ *
+ * Without a loop the work runs at once on the awaiting thread, which is not suspended. Whatever
+ * the work throws is rethrown by co_await.
+ */
+class Offload {
+ public:
+  /**
+   * @param loop    Loop to run the work through; NULL to run it at once
+   * @param io      Work that may block
+   */
+  Offload(EventLoop* loop, std::function<void()> io) : loop(loop), io(std::move(io)) {}
+
+  bool await_ready() {
+    if (loop != nullptr) {
+      return false;
+    }
+    try {
+      io();
+    }
+    catch (...) {
+      failure = std::current_exception();
+    }
+    return true;
+  }
+
+  void await_suspend(std::coroutine_handle<> awaiting) {
+    // nothing of this awaiter is touched once the work is done, since resuming may destroy it
+    loop->submit([this]() {
+      try {
+        io();
+      }
+      catch (...) {
+        failure = std::current_exception();
+      }
+    }, awaiting);
+  }
+
+  void await_resume() {
+    if (failure) {
+      std::rethrow_exception(failure);
+    }
+  }
+
+ private:
+  EventLoop* loop;
+  std::function<void()> io;
+  std::exception_ptr failure;
+};
+
+/**
+ * @brief EventLoop with a few I/O threads, driven by whichever thread calls runOnce() or run().
+ *
+ * Work submitted runs on the I/O threads; the coroutines waiting on it are queued and resumed
+ * by the thread driving the loop, so request handling code never runs on an I/O thread.
+ *
+ * @warning Every task must be done before the loop is destroyed.
+ */
+class IoEventLoop : public EventLoop {
+ public:
+  /**
+   * Starts the I/O threads.
+   *
+   * @param numThreads  Number of I/O threads; 0 is taken as 1
+   */
+  explicit IoEventLoop(const std::size_t numThreads);
+
+  /**
+   * Stops and joins the I/O threads.
+   */
+  ~IoEventLoop();
+
+  void submit(std::function<void()> io, std::coroutine_handle<> then) override;
+
+  /**
+   * Resumes every coroutine whose work is done, waiting for one if there is none yet.
+   *
+   * @return  Number of coroutines resumed
+   */
+  std::size_t runOnce();
+
+  /**
+   * Starts task and drives the loop until it is done.
+   *
+   * @param task    Task to run
+   * @return  Result of the task
+   */
+  template <typename T>
+  T run(Task<T> task) {
+    task.start();
+    while (!task.done()) {
+      runOnce();
+    }
+    return task.result();
+  }
+
+ private:
+  /**
+   * Body of each I/O thread: run queued work until stopped
+   */
+  void ioLoop();
+
+  /**
+   * Guards every field below
+   */
+  std::mutex latch;
+
+  /**
+   * Signalled when work is queued or the loop stops
+   */
+  std::condition_variable workReady;
+
+  /**
+   * Signalled when a coroutine is ready to be resumed
+   */
+  std::condition_variable resumeReady;
+
+  /**
+   * Work not yet taken by an I/O thread, with the coroutine to resume after it
+   */
+  std::deque<std::pair<std::function<void()>, std::coroutine_handle<> > > work;
+
+  /**
+   * Coroutines whose work is done, in the order it finished
+   */
+  std::deque<std::coroutine_handle<> > ready;
+
+  /**
+   * Set when the I/O threads are to exit
+   */
+  bool stopping;
+
+  /**
+   * The I/O threads
+   */
+  std::vector<std::thread> ioThreads;
+};
+
+}
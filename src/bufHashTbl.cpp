@@ -11,104 +11,171 @@
 #include "bufHashTbl.h"
 #include "exceptions/hash_already_present_exception.h"
 #include "exceptions/hash_not_found_exception.h"
-#include "exceptions/hash_table_exception.h"
 
 namespace badgerdb {
 
-int BufHashTbl::hash(const File* file, const PageId pageNo)
+std::uint64_t BufHashTbl::hash(const std::uint64_t key)
 {
-  int tmp, value;
-  tmp = (long)file;  // cast of pointer to the file object to an integer
-  value = (tmp + pageNo) % HTSIZE;
+  // murmur3 finalizer over the key spread by the golden ratio
+  std::uint64_t value = key * 0x9E3779B97F4A7C15ULL;
+  value ^= value >> 33;
+  value *= 0xFF51AFD7ED558CCDULL;
+  value ^= value >> 33;
+  value *= 0xC4CEB9FE1A85EC53ULL;
+  value ^= value >> 33;
   return value;
 }
 
-BufHashTbl::BufHashTbl(int htSize)
-	: HTSIZE(htSize)
+BufHashTbl::BufHashTbl(int htSize, int partitions)
+	: numPartitions(1), partitionBits(0)
 {
-  // allocate an array of pointers to hashBuckets
-  ht = new hashBucket* [htSize];
-  for(int i=0; i < HTSIZE; i++)
-    ht[i] = NULL;
+  while (numPartitions < partitions) {
+    numPartitions <<= 1;
+    partitionBits++;
+  }
+
+  std::uint32_t slotsPerPartition = 8;
+  while ((int) slotsPerPartition * numPartitions < htSize)
+    slotsPerPartition <<= 1;
+
+  this->partitions = new Partition[numPartitions];
+  for (int i = 0; i < numPartitions; i++) {
+    Partition& part = this->partitions[i];
+    part.slots = new hashBucket[slotsPerPartition];
+    part.mask = slotsPerPartition - 1;
+    part.count = 0;
+    for (std::uint32_t j = 0; j < slotsPerPartition; j++)
+      part.slots[j].key = EMPTY_KEY;
+  }
 }
 
 BufHashTbl::~BufHashTbl()
 {
-  for(int i = 0; i < HTSIZE; i++) {
-    hashBucket* tmpBuf = ht[i];
-    while (ht[i]) {
-      tmpBuf = ht[i];
-      ht[i] = ht[i]->next;
-      delete tmpBuf;
-    }
-  }
-  delete [] ht;
+  for (int i = 0; i < numPartitions; i++)
+    delete [] partitions[i].slots;
+  delete [] partitions;
 }
 
-void BufHashTbl::insert(const File* file, const PageId pageNo, const FrameId frameNo)
+std::mutex& BufHashTbl::partitionLatch(const File* file, const PageId pageNo)
 {
-  int index = hash(file, pageNo);
+  return partitionLatch(file->id(), pageNo);
+}
 
-  hashBucket* tmpBuc = ht[index];
-  while (tmpBuc) {
-    if (tmpBuc->file == file && tmpBuc->pageNo == pageNo)
-  		throw HashAlreadyPresentException(tmpBuc->file->filename(), tmpBuc->pageNo, tmpBuc->frameNo);
-    tmpBuc = tmpBuc->next;
-  }
+std::mutex& BufHashTbl::partitionLatch(const FileId fileId, const PageId pageNo)
+{
+  return partitionFor(hash(key(fileId, pageNo))).latch;
+}
 
-  tmpBuc = new hashBucket;
-  if (!tmpBuc)
-  	throw HashTableException();
+std::uint32_t BufHashTbl::probe(const Partition& part, const std::uint64_t key,
+                                const std::uint64_t hashValue)
+{
+  std::uint32_t index = (std::uint32_t) hashValue & part.mask;
+  while (part.slots[index].key != EMPTY_KEY && part.slots[index].key != key)
+    index = (index + 1) & part.mask;
+  return index;
+}
 
-  tmpBuc->file = (File*) file;
-  tmpBuc->pageNo = pageNo;
-  tmpBuc->frameNo = frameNo;
-  tmpBuc->next = ht[index];
-  ht[index] = tmpBuc;
+void BufHashTbl::grow(Partition& part)
+{
+  hashBucket* oldSlots = part.slots;
+  const std::uint32_t oldSize = part.mask + 1;
+
+  part.slots = new hashBucket[oldSize * 2];
+  part.mask = oldSize * 2 - 1;
+  for (std::uint32_t i = 0; i <= part.mask; i++)
+    part.slots[i].key = EMPTY_KEY;
+
+  for (std::uint32_t i = 0; i < oldSize; i++) {
+    if (oldSlots[i].key == EMPTY_KEY)
+      continue;
+    const std::uint64_t hashValue = hash(oldSlots[i].key);
+    part.slots[probe(part, oldSlots[i].key, hashValue)] = oldSlots[i];
+  }
+  delete [] oldSlots;
 }
 
-void BufHashTbl::lookup(const File* file, const PageId pageNo, FrameId &frameNo) 
+void BufHashTbl::insert(const File* file, const PageId pageNo, const FrameId frameNo)
 {
-  int index = hash(file, pageNo);
-  hashBucket* tmpBuc = ht[index];
-  while (tmpBuc) {
-    if (tmpBuc->file == file && tmpBuc->pageNo == pageNo)
-    {
-      frameNo = tmpBuc->frameNo; // return frameNo by reference
-      return;
-    }
-    tmpBuc = tmpBuc->next;
+  const std::uint64_t pageKey = key(file, pageNo);
+  const std::uint64_t hashValue = hash(pageKey);
+  Partition& part = partitionFor(hashValue);
+
+  std::uint32_t index = probe(part, pageKey, hashValue);
+  if (part.slots[index].key != EMPTY_KEY)
+    throw HashAlreadyPresentException(file->filename(), pageNo, part.slots[index].frameNo);
+
+  // keep the load factor at or below three quarters so probe runs stay short
+  if ((part.count + 1) * 4 > (part.mask + 1) * 3) {
+    grow(part);
+    index = probe(part, pageKey, hashValue);
   }
 
-  throw HashNotFoundException(file->filename(), pageNo);
+  part.slots[index].key = pageKey;
+  part.slots[index].frameNo = frameNo;
+  part.count++;
 }
 
-void BufHashTbl::remove(const File* file, const PageId pageNo) {
+bool BufHashTbl::tryLookup(const File* file, const PageId pageNo, FrameId &frameNo)
+{
+  const std::uint64_t pageKey = key(file, pageNo);
+  const std::uint64_t hashValue = hash(pageKey);
+  const Partition& part = partitionFor(hashValue);
+
+  const hashBucket& slot = part.slots[probe(part, pageKey, hashValue)];
+  if (slot.key == EMPTY_KEY)
+    return false;
+
+  frameNo = slot.frameNo; // return frameNo by reference
+  return true;
+}
+
+void BufHashTbl::lookup(const File* file, const PageId pageNo, FrameId &frameNo)
+{
+  if (!tryLookup(file, pageNo, frameNo))
+    throw HashNotFoundException(file->filename(), pageNo);
+}
 
-  int index = hash(file, pageNo);
-  hashBucket* tmpBuc = ht[index];
-  hashBucket* prevBuc = NULL;
-
-  while (tmpBuc)
-	{
-    if (tmpBuc->file == file && tmpBuc->pageNo == pageNo)
-		{
-      if(prevBuc) 
-				prevBuc->next = tmpBuc->next;
-      else
-				ht[index] = tmpBuc->next;
-
-      delete tmpBuc;
-      return;
-    }
-		else
-		{
-      prevBuc = tmpBuc;
-      tmpBuc = tmpBuc->next;
-    }
+bool BufHashTbl::tryRemove(const File* file, const PageId pageNo)
+{
+  return tryRemove(file->id(), pageNo);
+}
+
+bool BufHashTbl::tryRemove(const FileId fileId, const PageId pageNo)
+{
+  const std::uint64_t pageKey = key(fileId, pageNo);
+  const std::uint64_t hashValue = hash(pageKey);
+  Partition& part = partitionFor(hashValue);
+
+  std::uint32_t hole = probe(part, pageKey, hashValue);
+  if (part.slots[hole].key == EMPTY_KEY)
+    return false;
+
+  // shift back every later entry of the probe run whose home slot is not between the hole and it
+  std::uint32_t next = hole;
+  while (true) {
+    next = (next + 1) & part.mask;
+    const hashBucket& candidate = part.slots[next];
+    if (candidate.key == EMPTY_KEY)
+      break;
+
+    const std::uint32_t home = (std::uint32_t) hash(candidate.key) & part.mask;
+    const bool homeBetween = hole <= next ? (hole < home && home <= next)
+                                          : (hole < home || home <= next);
+    if (homeBetween)
+      continue;
+
+    part.slots[hole] = candidate;
+    hole = next;
   }
 
-  throw HashNotFoundException(file->filename(), pageNo);
+  part.slots[hole].key = EMPTY_KEY;
+  part.count--;
+  return true;
+}
+
+void BufHashTbl::remove(const File* file, const PageId pageNo) {
+  if (!tryRemove(file, pageNo))
+    throw HashNotFoundException(file->filename(), pageNo);
 }
 
 }
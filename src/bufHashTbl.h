@@ -7,73 +7,183 @@
 
 #pragma once
 
+#include <cstdint>
+#include <mutex>
 #include "file.h"
 
 namespace badgerdb {
 
 /**
 * @brief Declarations for buffer pool hash table
+*
+* One slot of the open-addressing table. A slot whose key is EMPTY_KEY is empty.
 */
 struct hashBucket {
 	/**
-	 * pointer a file object (more on this below)
+	 * ID of the page's file in the high half and the page number in the low half; see
+	 * BufHashTbl::key()
 	 */
-	File *file;
-
-	/**
-	 * page number within a file
-	 */
-	PageId pageNo;
+	std::uint64_t key;
 
 	/**
 	 * frame number of page in the buffer pool
 	 */
 	FrameId frameNo;
-
-	/**
-	 * Next node in the hash table
-	 */
-	hashBucket*   next;
 };
 
 
 /**
 * @brief Hash table class to keep track of pages in the buffer pool
 *
-* @warning This class is not threadsafe.
+* The table is split into partitions, each a flat array of slots probed linearly and guarded
+* by its own latch. The high bits of the hash pick the partition and the low bits the home slot.
+* Removal shifts later entries of the probe run back instead of leaving tombstones, so neither
+* insert nor remove allocates unless a partition has to grow past its initial size.
+*
+* insert(), lookup() and remove() do no locking of their own: callers must hold the latch
+* returned by partitionLatch() for the (file, pageNo) they operate on.
 */
 class BufHashTbl
 {
+ public:
+	/**
+	 * Number of lock partitions used when none is given to the constructor
+	 */
+  static const int DEFAULT_PARTITIONS = 16;
+
  private:
 	/**
-	 *	Size of Hash Table
+	 * @brief One lock partition of the table
+	 */
+  struct Partition {
+		/**
+		 * Latch guarding slots, mask and count
+		 */
+    std::mutex latch;
+
+		/**
+		 * Slot array, a power of two long
+		 */
+    hashBucket* slots;
+
+		/**
+		 * Number of slots minus one
+		 */
+    std::uint32_t mask;
+
+		/**
+		 * Number of occupied slots
+		 */
+    std::uint32_t count;
+  };
+
+	/**
+	 * Number of lock partitions, a power of two
+	 */
+  int numPartitions;
+
+	/**
+	 * Number of hash bits used to pick the partition
 	 */
-  int HTSIZE;
+  int partitionBits;
+
 	/**
 	 * Actual Hash table object
 	 */
-  hashBucket**  ht;
+  Partition* partitions;
+
+	/**
+	 * Key of an empty slot; no open file has ID File::INVALID_ID
+	 */
+  static const std::uint64_t EMPTY_KEY = 0;
 
 	/**
-	 * returns hash value between 0 and HTSIZE-1 computed using file and pageNo
+	 * Packs the ID of file and pageNo into one key, so that every handle on the same file finds
+	 * the same entries and slots are compared with a single test
 	 *
 	 * @param file   	File object
 	 * @param pageNo  Page number in the file
+	 * @return  			Key of the page
+	 */
+  static std::uint64_t key(const File* file, const PageId pageNo)
+  {
+    return key(file->id(), pageNo);
+  }
+
+	/**
+	 * Packs fileId and pageNo into one key, for a page whose file is known only by its ID
+	 *
+	 * @param fileId 	ID of the file
+	 * @param pageNo  Page number in the file
+	 * @return  			Key of the page
+	 */
+  static std::uint64_t key(const FileId fileId, const PageId pageNo)
+  {
+    return ((std::uint64_t) fileId << 32) | pageNo;
+  }
+
+	/**
+	 * returns a 64 bit hash of a key, mixed so that every input bit affects both the partition
+	 * and the slot
+	 *
+	 * @param key   	Key of the page
 	 * @return  			Hash value.
 	 */
-  int	 hash(const File* file, const PageId pageNo);
+  static std::uint64_t hash(const std::uint64_t key);
+
+	/**
+	 * Returns the partition holding entries with the given hash.
+	 */
+  Partition& partitionFor(const std::uint64_t hashValue)
+  {
+    return partitions[partitionBits == 0 ? 0 : hashValue >> (64 - partitionBits)];
+  }
+
+	/**
+	 * Doubles the slot array of a partition and re-inserts its entries.
+	 */
+  void grow(Partition& part);
+
+	/**
+	 * Returns the slot holding key in part, or the empty slot ending its probe run.
+	 */
+  static std::uint32_t probe(const Partition& part, const std::uint64_t key,
+                             const std::uint64_t hashValue);
 
  public:
 	/**
    * Constructor of BufHashTbl class
+	 *
+	 * @param htSize					Total number of slots, rounded up so each partition holds a power of two
+	 * @param partitions			Number of lock partitions, rounded up to a power of two
 	 */
-	BufHashTbl(const int htSize);  // constructor
+	BufHashTbl(const int htSize, const int partitions = DEFAULT_PARTITIONS);  // constructor
 
 	/**
    * Destructor of BufHashTbl class
 	 */
   ~BufHashTbl(); // destructor
-	
+
+	/**
+   * Returns the latch of the partition holding (file, pageNo). It must be held across any
+	 * insert, lookup or remove of that entry.
+	 *
+	 * @param file   	File object
+	 * @param pageNo  Page number in the file
+	 * @return				Partition latch
+	 */
+  std::mutex& partitionLatch(const File* file, const PageId pageNo);
+
+	/**
+   * Returns the latch of the partition holding (fileId, pageNo), as partitionLatch(file, pageNo)
+	 * does for a page whose file is known only by its ID.
+	 *
+	 * @param fileId 	ID of the file
+	 * @param pageNo  Page number in the file
+	 * @return				Partition latch
+	 */
+  std::mutex& partitionLatch(const FileId fileId, const PageId pageNo);
+
 	/**
    * Insert entry into hash table mapping (file, pageNo) to frameNo.
 	 *
@@ -81,29 +191,57 @@ class BufHashTbl
 	 * @param pageNo 	Page number in the file
 	 * @param frameNo Frame number assigned to that page of the file
    * @throws  HashAlreadyPresentException	if the corresponding page already exists in the hash table
-   * @throws  HashTableException (optional) if could not create a new bucket as running of memory
 	 */
   void insert(const File* file, const PageId pageNo, const FrameId frameNo);
 
 	/**
    * Check if (file, pageNo) is currently in the buffer pool (ie. in
+   * the hash table).
+	 *
+	 * @param file  	File object
+	 * @param pageNo	Page number in the file
+	 * @param frameNo Frame number reference, set only when the entry is found
+	 * @return				True if the entry is in the hash table
+	 */
+  bool tryLookup(const File* file, const PageId pageNo, FrameId &frameNo);
+
+	/**
+   * Check if (file, pageNo) is currently in the buffer pool (ie. in
    * the hash table).
 	 *
 	 * @param file  	File object
 	 * @param pageNo	Page number in the file
 	 * @param frameNo Frame number reference
-   * @throws HashNotFoundException if the page entry is not found in the hash table 
+   * @throws HashNotFoundException if the page entry is not found in the hash table
 	 */
   void lookup(const File* file, const PageId pageNo, FrameId &frameNo);
 
+	/**
+   * Delete entry (file,pageNo) from hash table if it is present.
+	 *
+	 * @param file   	File object
+	 * @param pageNo  Page number in the file
+	 * @return				True if an entry was removed
+	 */
+  bool tryRemove(const File* file, const PageId pageNo);
+
+	/**
+   * Delete entry (fileId,pageNo) from hash table if it is present.
+	 *
+	 * @param fileId 	ID of the file
+	 * @param pageNo  Page number in the file
+	 * @return				True if an entry was removed
+	 */
+  bool tryRemove(const FileId fileId, const PageId pageNo);
+
 	/**
    * Delete entry (file,pageNo) from hash table.
 	 *
 	 * @param file   	File object
 	 * @param pageNo  Page number in the file
-   * @throws HashNotFoundException if the page entry is not found in the hash table 
+   * @throws HashNotFoundException if the page entry is not found in the hash table
 	 */
-  void remove(const File* file, const PageId pageNo);  
+  void remove(const File* file, const PageId pageNo);
 };
 
 }
@@ -11,35 +11,101 @@
 
 #include <memory>
 #include <iostream>
+#include <new>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <utility>
+#include <vector>
 #include "buffer.h"
+#include "exceptions/badgerdb_exception.h"
 #include "exceptions/buffer_exceeded_exception.h"
 #include "exceptions/page_not_pinned_exception.h"
 #include "exceptions/page_pinned_exception.h"
 #include "exceptions/bad_buffer_exception.h"
-#include "exceptions/hash_not_found_exception.h"
+#include "exceptions/invalid_pool_size_exception.h"
+#include "exceptions/invalid_quota_exception.h"
+#include "exceptions/invalid_manifest_exception.h"
+#include "exceptions/invalid_page_exception.h"
 
 namespace badgerdb { 
 
+///most pages evictFile and the destructor write with one call
+static const std::size_t MAX_WRITE_RUN = 64;
+
+///the throwing calls are the try* calls followed by this
+static void throwIfFailed(const Status status, const File* file, const PageId pageNo)
+{
+    switch(status){
+    case Status::OK:
+        return;
+    case Status::INSUFFICIENT_SPACE:
+        ///only Page::tryInsertRecord reports this; no BufMgr call does, so it is never taken as success
+        throw BadgerDbException("buffer manager call reported INSUFFICIENT_SPACE");
+    case Status::BUFFER_EXCEEDED:
+        throw BufferExceededException();
+    case Status::INVALID_PAGE:
+        throw InvalidPageException(pageNo, file->filename());
+    }
+}
+
 //----------------------------------------
 // Constructor of the class BufMgr
 //----------------------------------------
 
-BufMgr::BufMgr(std::uint32_t bufs)
-	: numBufs(bufs) {
-	bufDescTable = new BufDesc[bufs];
+BufMgr::BufMgr(std::uint32_t bufs, ReplacementPolicyType policyType, HugePageMode hugePages,
+               std::uint32_t maxBufsIn)
+	: victimBatch(1),
+	  numBufs(bufs),
+	  maxBufs(maxBufsIn > bufs ? maxBufsIn : bufs),
+	  compressedTier(NULL),
+	  secondaryCache(NULL),
+	  eventLoop(NULL),
+	  anyQuota(false),
+	  anyReservation(false),
+	  dirtyFrames(0),
+	  writerThread(NULL),
+	  writerStop(false),
+	  writerKicked(false),
+	  writerRounds(0),
+	  writerCleanTarget(0),
+	  writerHighWater(bufs),
+	  writerDirtyFraction(1.0),
+	  writerInterval(0),
+	  prefetchThread(NULL),
+	  prefetchStop(false),
+	  prefetchInFlight(NULL) {
+	///descriptors, views and arena cover maxBufs so resize() never moves them
+	///operator new[] only aligns for the basic types, so the descriptors' cache lines are laid out by hand
+	void* descs;
+	if (posix_memalign(&descs, CACHE_LINE_SIZE, sizeof(BufDesc) * maxBufs) != 0) {
+		throw std::bad_alloc();
+	}
+	bufDescTable = static_cast<BufDesc*>(descs);
 
-  for (FrameId i = 0; i < bufs; i++) 
+  for (FrameId i = 0; i < maxBufs; i++) 
   {
+  	new (&bufDescTable[i]) BufDesc();
   	bufDescTable[i].frameNo = i;
-  	bufDescTable[i].valid = false;
   }
 
-  bufPool = new Page[bufs];
+  ///every frame is a Page viewing its slice of one contiguous arena
+  arena = new BufferArena(maxBufs, hugePages);
+  bufPool = static_cast<Page*>(::operator new(sizeof(Page) * maxBufs));
+  for (FrameId i = 0; i < bufs; i++)
+  {
+  	new (&bufPool[i]) Page(arena->frame(i));
+  }
 
-  int htsize = ((((int) (bufs * 1.2))*2)/2)+1;
+  int htsize = bufs * 2;  // keep the hash table at most half full
   hashTable = new BufHashTbl (htsize);  // allocate the buffer hash table
 
-  clockHand = bufs - 1;
+  policy = ReplacementPolicy::create(policyType, bufs, maxBufs);
 }
 
 /**
@@ -48,250 +114,2269 @@ BufMgr::BufMgr(std::uint32_t bufs)
  */
 BufMgr::~BufMgr() {
     
-    ///flush files
-    for(uint32_t j = 0; j > numBufs; j++){
-        if(bufDescTable[j].dirty){
-            flushFile(bufDescTable[j].file);
+    ///the writer and the prefetcher use every structure below
+    stopPrefetcher();
+    stopBackgroundWriter();
+
+    ///the next start reloads what is resident now
+    if(!shutdownManifest.empty()){
+        try {
+            dumpResidentPages(shutdownManifest);
+        }
+        catch (InvalidManifestException&) {
+        }
+    }
+    
+    ///write back every dirty page, pinned or not, one file at a time, through a handle opened by
+    ///name since the ones the pages were loaded through may be gone; a destructor must not throw
+    std::unordered_map<FileId, std::vector<std::pair<PageId, FrameId> > > dirtyPages;
+    for(uint32_t j = 0; j < numBufs.load(); j++){
+        if(bufDescTable[j].valid() && bufDescTable[j].dirty()){
+            dirtyPages[bufDescTable[j].fileId].push_back(std::make_pair(bufDescTable[j].pageNo, j));
+        }
+    }
+    for(std::unordered_map<FileId, std::vector<std::pair<PageId, FrameId> > >::iterator it = dirtyPages.begin();
+        it != dirtyPages.end(); ++it){
+        std::size_t written = 0;
+        try {
+            File file = File::open(residentFileName(it->first));
+            writeRuns(&file, it->second, written);
+        }
+        catch (...) {
         }
     }
     
     
     ///Now
+    delete compressedTier;
+    delete secondaryCache;
+    delete policy;
     delete hashTable;
-    delete[] bufPool;
-    delete[] bufDescTable;
+    for(uint32_t j = 0; j < numBufs.load(); j++){
+        bufPool[j].~Page();
+    }
+    ::operator delete(bufPool);
+    delete arena;
+    for(uint32_t j = 0; j < maxBufs; j++){
+        bufDescTable[j].~BufDesc();
+    }
+    free(bufDescTable);
     
     
     
 }
 
 /**
-*  Move the "hand" pointer along the buffer clock. use the remainder to stay in bounds.
-* Input: Address to frame (for reference return)
-* Output: frame as a referenced value.
-*/
-void BufMgr::advanceClock()
+ *  Pin a frame and tell the policy when it stops being evictable. Caller holds the frame's latch.
+ * Input: frame number
+ * Output: N/A
+ */
+void BufMgr::pinFrame(const FrameId frame)
 {
-    clockHand = (clockHand + 1) % numBufs;
+    if ((bufDescTable[frame].state.fetch_add(1, std::memory_order_acq_rel) & BufDesc::PIN_MASK) == 0) {
+        bufDescTable[frame].bumpVersion();
+        ///the policy already counts a sticky frame as pinned
+        if (bufDescTable[frame].priority != PagePriority::STICKY) {
+            policy->pinned(frame);
+        }
+    }
 }
 
-///Implement the clock algorithm
-///add a pinned count, if pinned count = numBufs, then throw exception
-///run through each buf and check for validity following diagram.
-void BufMgr::allocBuf(FrameId & frame) 
+/**
+ *  Unpin a frame and tell the policy when it becomes evictable. Caller holds the frame's latch.
+ * Input: frame number
+ * Output: N/A
+ */
+void BufMgr::unpinFrame(const FrameId frame)
 {
-    ///track if a frame has been found
-    bool frameFound = false;
-    
-    std::uint32_t pinnedCount = 0;
-    
-    ///start loop, until frame is found. Only time it will leave loop is if frame is found
-    ///or bufferexceededexception occurs
-    while(!frameFound && (pinnedCount < numBufs)){
-        
-        advanceClock();
-        
-        ///found a buffer frame that can be used, exit loop
-        if(!bufDescTable[clockHand].valid){
-        
-            frameFound = true;
-            break;
-        
-        } ///check the refbit, if it is false then frame is found and the entry in the hashtable needs to be removed
-        else if(bufDescTable[clockHand].refbit){
-            bufDescTable[clockHand].refbit = false;
-            continue;
-        }else if(bufDescTable[clockHand].pinCnt > 0) {
-            pinnedCount++;
-            continue;
-        }else{
-            
-            if(bufDescTable[clockHand].dirty){
-                bufDescTable[clockHand].file->writePage(bufPool[clockHand]);
+    if ((bufDescTable[frame].state.fetch_sub(1, std::memory_order_acq_rel) & BufDesc::PIN_MASK) == 1) {
+        bufDescTable[frame].bumpVersion();
+        if (bufDescTable[frame].priority != PagePriority::STICKY) {
+            policy->unpinned(frame);
+        }
+    }
+}
+
+///only a first pin goes through the frame's latch; the partition latch keeps the frame's page
+void BufMgr::pinResident(const FrameId frame)
+{
+    if (!bufDescTable[frame].tryPin()) {
+        std::lock_guard<std::mutex> descGuard(bufDescTable[frame].latch);
+        pinFrame(frame);
+    }
+}
+
+///only a last pin, or one that dirties a clean page, goes through the frame's latch
+void BufMgr::unpinResident(const FrameId frame, const File* file, const PageId pageNo, const bool dirty)
+{
+    BufDesc& desc = bufDescTable[frame];
+    if (desc.tryUnpin(dirty)) {
+        return;
+    }
+    std::lock_guard<std::mutex> descGuard(desc.latch);
+    ///check if pin cnt is already set to 0. throw appropriate error
+    if (desc.pinCnt() == 0) {
+        throw PageNotPinnedException(file->filename(), pageNo, frame);
+    }
+    ///set dirty bit if input bit is true
+    if (dirty && desc.setFlag(BufDesc::DIRTY)) {
+        dirtyFrames++;
+    }
+    ///decrement pin count
+    unpinFrame(frame);
+}
+
+///if the policy reports every frame pinned, then throw exception
+void BufMgr::allocBuf(FrameId & frame, const File* file) 
+{
+    throwIfFailed(tryAllocBuf(frame, file), file, Page::INVALID_NUMBER);
+}
+
+///Search for a frame under victimLatch, then write the pages it evicted to the secondary cache
+Status BufMgr::tryAllocBuf(FrameId & frame, const File* file)
+{
+    std::vector<Admission> admitted;
+    Status status;
+    try {
+        ///only one victim search at a time; pins and unpins go on meanwhile
+        std::lock_guard<std::mutex> victimGuard(victimLatch);
+        status = searchVictims(frame, file, admitted);
+    }
+    catch (...) {
+        ///pages claimed before the failure are in admitting and must still be written
+        admitToSecondaryCache(admitted);
+        throw;
+    }
+    admitToSecondaryCache(admitted);
+    return status;
+}
+
+///Ask the policy for candidates until one can be reserved
+Status BufMgr::searchVictims(FrameId & frame, const File* file, std::vector<Admission>& admitted)
+{
+    ///a group at its quota makes room among its own pages; one over its quota gives up pages first
+    std::uint32_t ownGroup;
+    const std::uint32_t shrinking = shrinkingGroup(file, ownGroup);
+    if(shrinking != NO_GROUP && shrinking == ownGroup){
+        return claimFromGroup(shrinking, frame, admitted) ? Status::OK : Status::BUFFER_EXCEEDED;
+    }
+
+    ///frames an earlier search claimed are ready to use as they are
+    if(!reservoir.empty()){
+        frame = reservoir.back();
+        reservoir.pop_back();
+        return Status::OK;
+    }
+
+    ///a group over its quota gives up a page before anyone else's is evicted
+    if(shrinking != NO_GROUP && claimFromGroup(shrinking, frame, admitted)){
+        return Status::OK;
+    }
+
+    ///keep claiming until the batch is full or the policy runs out of unpinned frames; an empty
+    ///frame ends the batch, since nothing needs evicting while the policy still has those;
+    ///reserved pages are passed over for a lap of the pool at most, in case nothing else is unpinned
+    FrameId candidate;
+    bool found = false;
+    bool batching = true;
+    std::uint32_t reservedSkips = 0;
+    try {
+        while((!found || (batching && reservoir.size() + 1 < victimBatch)) && policy->pickVictim(candidate)){
+            bufStats.add(BufCounter::SWEEP_STEPS, file, policy->lastSweepSteps());
+            if(spareVictim(candidate)){
+                continue;
+            }
+            if(reservedSkips < numBufs.load() && reservedVictim(candidate, ownGroup)){
+                reservedSkips++;
+                continue;
+            }
+            const bool empty = !bufDescTable[candidate].valid();
+            if(!claimFrame(candidate, admitted)){
+                continue;
+            }
+            batching = !empty;
+            if(found){
+                reservoir.push_back(candidate);
+            }else{
+                frame = candidate;
+                found = true;
             }
-            frameFound = true;
-            ///remove the hashtable entry
-            hashTable->remove(bufDescTable[clockHand].file, bufDescTable[clockHand].pageNo);
         }
-    
     }
-    ///All pages are pinned, otherwise found free frame
-    if(pinnedCount == numBufs){
-        throw BufferExceededException();
-    } else {
-        frame = clockHand;
-        
-        bufDescTable[clockHand].Clear();
+    catch (...) {
+        ///a failed write-back ends the batch; what was claimed before it is kept for later
+        if(found){
+            reservoir.push_back(frame);
+        }
+        throw;
     }
-    
+
+    ///All pages are pinned
+    return found ? Status::OK : Status::BUFFER_EXCEEDED;
+}
+
+///a spared page counts as referenced again, so the policy moves on before offering it anew
+bool BufMgr::spareVictim(const FrameId candidate)
+{
+    BufDesc& desc = bufDescTable[candidate];
+    std::lock_guard<std::mutex> descGuard(desc.latch);
+    if(desc.chances == 0 || desc.pinCnt() > 0){
+        return false;
+    }
+    desc.chances--;
+    policy->accessed(candidate);
+    return true;
+}
+
+///a page of a group still within its reservation is left to it, like a spared page
+bool BufMgr::reservedVictim(const FrameId candidate, const std::uint32_t ownGroup)
+{
+    if(!anyReservation.load(std::memory_order_relaxed)){
+        return false;
+    }
+    BufDesc& desc = bufDescTable[candidate];
+    std::lock_guard<std::mutex> descGuard(desc.latch);
+    if(!desc.valid() || desc.pinCnt() > 0){
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> indexGuard(fileIndexLatch);
+        std::unordered_map<FileId, FileFrames>::const_iterator it = fileFrames.find(desc.fileId);
+        if(it == fileFrames.end() || it->second.group == NO_GROUP || it->second.group == ownGroup){
+            return false;
+        }
+        const FrameQuota& quota = quotas[it->second.group];
+        if(quota.frames > quota.minFrames){
+            return false;
+        }
+    }
+    policy->accessed(candidate);
+    return true;
+}
+
+///the policy's next few victims first, then the group's own file lists, so the cost of a miss
+///is bounded by the group's quota rather than the pool size
+bool BufMgr::claimFromGroup(const std::uint32_t group, FrameId& frame, std::vector<Admission>& admitted)
+{
+    std::vector<FrameId> candidates;
+    policy->evictionCandidates(candidates, GROUP_CANDIDATES);
+    for(std::size_t i = 0; i < candidates.size(); i++){
+        if(frameGroup(candidates[i]) == group && !spareVictim(candidates[i]) && claimFrame(candidates[i], admitted)){
+            frame = candidates[i];
+            return true;
+        }
+    }
+
+    std::vector<FrameId> members;
+    {
+        std::lock_guard<std::mutex> indexGuard(fileIndexLatch);
+        const std::vector<FileId>& files = quotas[group].files;
+        for(std::size_t i = 0; i < files.size(); i++){
+            std::unordered_map<FileId, FileFrames>::const_iterator it = fileFrames.find(files[i]);
+            if(it == fileFrames.end()){
+                continue;
+            }
+            for(FrameId f = it->second.head; f != BufDesc::INVALID_FRAME; f = bufDescTable[f].fileNext){
+                members.push_back(f);
+            }
+        }
+    }
+
+    ///lists are pushed at the front, so from the back each file's least recently loaded page comes
+    ///first; a spared page is looked at again once every other page has been
+    bool spared = true;
+    while(spared){
+        spared = false;
+        for(std::size_t i = members.size(); i-- > 0; ){
+            {
+                ///the policy never offers a sticky page, and neither does this walk
+                std::lock_guard<std::mutex> descGuard(bufDescTable[members[i]].latch);
+                if(bufDescTable[members[i]].priority == PagePriority::STICKY){
+                    continue;
+                }
+            }
+            if(spareVictim(members[i])){
+                spared = true;
+                continue;
+            }
+            if(claimFrame(members[i], admitted)){
+                frame = members[i];
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+///the file a frame's page belongs to is read under the frame's latch, its group under the index's
+std::uint32_t BufMgr::frameGroup(const FrameId frame)
+{
+    BufDesc& desc = bufDescTable[frame];
+    std::lock_guard<std::mutex> descGuard(desc.latch);
+    if(!desc.valid()){
+        return NO_GROUP;
+    }
+    std::lock_guard<std::mutex> indexGuard(fileIndexLatch);
+    std::unordered_map<FileId, FileFrames>::const_iterator it = fileFrames.find(desc.fileId);
+    return it == fileFrames.end() ? NO_GROUP : it->second.group;
+}
+
+///Reserve one frame, as allocBuf does for each candidate the policy offers
+///a valid candidate is written back if dirty and removed from the hash table
+bool BufMgr::claimFrame(const FrameId candidate, std::vector<Admission>& admitted)
+{
+    BufDesc& desc = bufDescTable[candidate];
+    std::unique_lock<std::mutex> descGuard(desc.latch);
+
+    ///pinned after the policy looked at it; the policy has been told by now
+    if(desc.pinCnt() > 0){
+        return false;
+    }
+
+    ///found a buffer frame that can be used, reserve it and exit loop
+    pinFrame(candidate);
+    if(!desc.valid()){
+        return true;
+    }
+
+    ///the reservation keeps other searches away while the victim is written back and unhashed;
+    ///the handle the page was loaded through may be gone, so it is written through one opened by name
+    const FileId victimFile = desc.fileId;
+    const PageId victimPage = desc.pageNo;
+    const std::string victimName = residentFileName(victimFile);
+    const bool victimDirty = desc.clearFlag(BufDesc::DIRTY);
+    descGuard.unlock();
+
+    if(victimDirty){
+        ///the background writer, if any, is behind; write this one here and let it catch up
+        dirtyFrames--;
+        kickWriter();
+        try {
+            File file = File::open(victimName);
+            std::lock_guard<std::mutex> ioGuard(ioLatch);
+            file.writePage(bufPool[candidate]);
+        }
+        catch (...) {
+            descGuard.lock();
+            if(desc.holds(victimFile, victimPage)){
+                if(desc.setFlag(BufDesc::DIRTY)){
+                    dirtyFrames++;
+                }
+                unpinFrame(candidate);
+            }
+            throw;
+        }
+        bufStats.add(BufCounter::DISK_WRITES, victimFile, victimName);
+    }
+
+    ///remove the hashtable entry unless another thread pinned or dirtied the page meanwhile
+    {
+        std::lock_guard<std::mutex> partitionGuard(hashTable->partitionLatch(victimFile, victimPage));
+        descGuard.lock();
+        if(!desc.holds(victimFile, victimPage)){
+            ///disposePage dropped the page meanwhile and left the frame free; flushFile and
+            ///invalidateFile cannot, since they throw PagePinnedException on the frame we pinned
+            pinFrame(candidate);
+            return true;
+        }
+        if(desc.pinCnt() != 1 || desc.dirty()){
+            unpinFrame(candidate);
+            return false;
+        }
+        ///stored, or entered in admitting, before the page leaves the hash table, so a miss on it
+        ///always finds the copy; the cache file itself is written by the caller once victimLatch
+        ///is released
+        if(compressedTier != NULL){
+            compressedTier->put(victimFile, victimPage, bufPool[candidate].bytes_);
+        }
+        if(secondaryCache != NULL){
+            admitted.push_back(Admission());
+            Admission& admission = admitted.back();
+            admission.fileName = victimName;
+            admission.fileId = victimFile;
+            admission.pageNo = victimPage;
+            admission.bytes.assign(bufPool[candidate].bytes_, bufPool[candidate].bytes_ + Page::SIZE);
+            std::lock_guard<std::mutex> admitGuard(admitLatch);
+            admitting[std::make_pair(victimFile, victimPage)]++;
+        }
+        hashTable->tryRemove(victimFile, victimPage);
+        policy->evicted(candidate, victimFile, victimPage);
+        unlinkFrame(candidate);
+        desc.Clear();
+        desc.state.store(1, std::memory_order_release);
+        desc.bumpVersion();
+        descGuard.unlock();
+    }
+    bufStats.add(victimDirty ? BufCounter::DIRTY_EVICTIONS : BufCounter::CLEAN_EVICTIONS, victimFile, victimName);
+    return true;
+}
+
+///the writes themselves hold no latch of ours; only the bookkeeping around them does
+void BufMgr::admitToSecondaryCache(const std::vector<Admission>& admitted)
+{
+    if(admitted.empty()){
+        return;
+    }
+    for(std::size_t i = 0; i < admitted.size(); i++){
+        secondaryCache->put(admitted[i].fileName, admitted[i].pageNo, admitted[i].bytes.data());
+        std::lock_guard<std::mutex> admitGuard(admitLatch);
+        std::map<std::pair<FileId, PageId>, std::uint32_t>::iterator it =
+            admitting.find(std::make_pair(admitted[i].fileId, admitted[i].pageNo));
+        if(--it->second == 0){
+            admitting.erase(it);
+        }
+    }
+    admitDone.notify_all();
+}
+
+///Page::INVALID_NUMBER is below every page number, so it finds the file's first page in flight
+void BufMgr::awaitAdmission(const FileId file, const PageId pageNo)
+{
+    std::unique_lock<std::mutex> admitGuard(admitLatch);
+    admitDone.wait(admitGuard, [this, file, pageNo]() {
+        std::map<std::pair<FileId, PageId>, std::uint32_t>::const_iterator it =
+            admitting.lower_bound(std::make_pair(file, pageNo));
+        return it == admitting.end() || it->first.first != file ||
+               (pageNo != Page::INVALID_NUMBER && it->first.second != pageNo);
+    });
 }
 
 /**
-*  Check to see if the page is in the buffer, if so then return the pointer to the page
-*  If the page is not located in the buffer then add it to the buffer and return the page pointer.
- * Input: file pointer, pageNo, address of page(for reference return)
- * Outpu: Returns the address of a page for reading
+ *  Grow or shrink the pool. Frames above the new size are claimed like victims, one at a time,
+ *  so they are written back and unhashed, and stay pinned by us while retired.
+ * Input: new number of frames
+ * Output: N/A
  */
-void BufMgr::readPage(File* file, const PageId pageNo, Page*& page)
+void BufMgr::resize(const std::uint32_t newBufs)
 {
-    FrameId frameNo;
-    /// check whether page is already in buffer pool with lookup(), throws HashNotFoundExc.
-    try {
-        hashTable->lookup(file, pageNo, frameNo); /// no exception thrown, in hash table
+    if(newBufs == 0 || newBufs > maxBufs){
+        throw InvalidPoolSizeException(newBufs, maxBufs);
+    }
 
-        /// set appropriate refbit
-        bufDescTable[frameNo].refbit = 1;
+    std::lock_guard<std::mutex> resizeGuard(resizeLatch);
+    const std::uint32_t oldBufs = numBufs.load();
 
-        /// increment pin count
-        bufDescTable[frameNo].pinCnt++;
-        /// return pointer to frame containing the page via page parameter
-        page = &bufPool[frameNo];
+    if(newBufs > oldBufs){
+        ///retired frames were left pinned and empty; nobody else can reach them until the policy does
+        for(FrameId i = oldBufs; i < newBufs; i++){
+            new (&bufPool[i]) Page(arena->frame(i));
+            std::lock_guard<std::mutex> descGuard(bufDescTable[i].latch);
+            bufDescTable[i].Clear();
+        }
+        std::lock_guard<std::mutex> victimGuard(victimLatch);
+        policy->resize(newBufs);
+        numBufs.store(newBufs);
+        rescaleHighWater();
+        return;
     }
-    catch (const HashNotFoundException& e) {
-        /// not in buffer pool, need to add to buffer
 
-        /// allocate buffer frame
-        allocBuf(frameNo);
-        /// add to bufPool
-        bufPool[frameNo] = file->readPage(pageNo);
-        /// set the description table
-        bufDescTable[frameNo].Set(file, pageNo);
-        /// insert page into hash table
-        hashTable->insert(file, pageNo, frameNo);
-        /// return the page pointer
-        page = &bufPool[frameNo];
+    ///drain from the top; a frame pinned by someone else is retried until it is unpinned
+    for(FrameId i = newBufs; i < oldBufs; i++){
+        try {
+            while(true){
+                bool claimed = false;
+                std::vector<Admission> admitted;
+                try {
+                    std::lock_guard<std::mutex> victimGuard(victimLatch);
+                    ///a frame in the reservoir is already empty and pinned by us
+                    std::vector<FrameId>::iterator held = std::find(reservoir.begin(), reservoir.end(), i);
+                    if(held != reservoir.end()){
+                        reservoir.erase(held);
+                        claimed = true;
+                    }else{
+                        claimed = claimFrame(i, admitted);
+                    }
+                }
+                catch (...) {
+                    admitToSecondaryCache(admitted);
+                    throw;
+                }
+                admitToSecondaryCache(admitted);
+                if(claimed)
+                    break;
+                bufStats.add(BufCounter::PIN_WAITS, NULL);
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        catch (...) {
+            for(FrameId j = newBufs; j < i; j++){
+                releaseBuf(j);
+            }
+            throw;
+        }
     }
 
+    {
+        std::lock_guard<std::mutex> victimGuard(victimLatch);
+        numBufs.store(newBufs);
+        policy->resize(newBufs);
+    }
+    rescaleHighWater();
+    for(FrameId i = newBufs; i < oldBufs; i++){
+        bufPool[i].~Page();
+    }
+    arena->release(newBufs, oldBufs - newBufs);
 }
-    
+
 /**
- *  updates the descTable to correlate with a page that is no longer pinned in the buffer
- *  Throws exception if the page is not pinned. Does not throw anything if the page is not in the buffer
- * Input: file pointer, pageNo, boolean dirty
- * Outpu: N/A
+ *  Set how many victims a search for a frame claims, handing back reserved frames beyond the new batch
+ * Input: victims per search
+ * Output: N/A
  */
-void BufMgr::unPinPage(File* file, const PageId pageNo, const bool dirty) 
+void BufMgr::setVictimBatch(const std::uint32_t batch)
 {
-	FrameId frameNo = 0;		
-	///check hashtable for page
-	try {
-		hashTable->lookup(file, pageNo, frameNo);
-		///check if pin cnt is already set to 0. throw appropriate error
-		if (bufDescTable[frameNo].pinCnt == 0){
-		throw PageNotPinnedException(file->filename(), pageNo, frameNo);	
-		}
-		///set dirty bit if input bit is true
-        if(dirty){
-            bufDescTable[frameNo].dirty = dirty;
+    std::lock_guard<std::mutex> victimGuard(victimLatch);
+    victimBatch = batch == 0 ? 1 : batch;
+    while(reservoir.size() >= victimBatch){
+        releaseBuf(reservoir.back());
+        reservoir.pop_back();
+    }
+}
+
+///frames waiting in the reservoir
+std::uint32_t BufMgr::reservedFrames()
+{
+    std::lock_guard<std::mutex> victimGuard(victimLatch);
+    return reservoir.size();
+}
+
+///keep the writer's high-water mark the same fraction of the pool after a resize
+void BufMgr::rescaleHighWater()
+{
+    std::lock_guard<std::mutex> writerGuard(writerLatch);
+    writerHighWater = static_cast<std::uint32_t>(writerDirtyFraction * numBufs.load());
+}
+
+/**
+ *  Reserve a frame for a page read through a ring. The frame the ring used a full lap ago is taken
+ *  back if it still holds the ring's page and nobody has it pinned; otherwise a frame comes from
+ *  allocBuf and joins the ring.
+ * Input: ring, frame (for reference return)
+ * Output: N/A
+ */
+Status BufMgr::tryAllocRingBuf(BufferRing& ring, FrameId & frame, const File* file)
+{
+    BufferRing::Slot& slot = ring.slots[ring.next];
+    ring.next = (ring.next + 1) % ring.slots.size();
+
+    if(slot.fileId != File::INVALID_ID){
+        bool claimed = false;
+        std::vector<Admission> admitted;
+        try {
+            std::lock_guard<std::mutex> victimGuard(victimLatch);
+            bool ours;
+            {
+                ///the policy may have handed the frame to a page someone else wanted since, and a
+                ///page given a priority is no longer the scan's to recycle
+                std::lock_guard<std::mutex> descGuard(bufDescTable[slot.frameNo].latch);
+                ours = bufDescTable[slot.frameNo].holds(slot.fileId, slot.pageNo) &&
+                       bufDescTable[slot.frameNo].priority == PagePriority::NORMAL;
+            }
+            claimed = ours && claimFrame(slot.frameNo, admitted);
         }
-            
-		///decrement pin count
-		bufDescTable[frameNo].pinCnt--;	
-		
-	}
-	catch(const HashNotFoundException& e){
-		
-	}
+        catch (...) {
+            admitToSecondaryCache(admitted);
+            throw;
+        }
+        admitToSecondaryCache(admitted);
+        if(claimed){
+            frame = slot.frameNo;
+            slot.fileId = File::INVALID_ID;
+            return Status::OK;
+        }
+    }
+    const Status status = tryAllocBuf(frame, file);
+    if(status != Status::OK){
+        return status;
+    }
+    slot.frameNo = frame;
+    slot.fileId = File::INVALID_ID;
+    return Status::OK;
+}
 
-	
-    
+/**
+ *  Note which page the ring's latest frame now holds, so the ring can tell later whether the page is still there
+ * Input: ring, frame number, file pointer, pageNo
+ * Output: N/A
+ */
+void BufMgr::ringLoaded(BufferRing& ring, const FrameId frame, const File* file, const PageId pageNo)
+{
+    BufferRing::Slot& slot = ring.slots[(ring.next + ring.slots.size() - 1) % ring.slots.size()];
+    if(slot.frameNo == frame){
+        slot.fileId = file->id();
+        slot.pageNo = pageNo;
+    }
 }
 
 /**
- *  create a page within a file when one does not already exist
- *  Add to buffer since it is newly created and this is a form of access
+ *  Clear a frame reserved by allocBuf so the policy can hand it out again.
+ * Input: frame number
+ * Output: N/A
+ */
+void BufMgr::releaseBuf(const FrameId frame)
+{
+    std::lock_guard<std::mutex> descGuard(bufDescTable[frame].latch);
+    policy->freed(frame);
+    unpinFrame(frame);
+    bufDescTable[frame].Clear();
+}
+
+/**
+*  Check to see if the page is in the buffer, if so then return the pointer to the page
+*  If the page is not located in the buffer then add it to the buffer and return the page pointer.
+*  A page that is still being prefetched counts as in the buffer; wait for it to arrive.
  * Input: file pointer, pageNo, address of page(for reference return)
- * Output: returns a page address that is now allocated
+ * Outpu: Returns the address of a page for reading
  */
-void BufMgr::allocPage(File* file, PageId &pageNo, Page*& page) 
+void BufMgr::readPage(File* file, const PageId pageNo, Page*& page)
 {
-	FrameId frameNo;		
-	///allocate page and get buffer frame pool
-	Page filePage = file->allocatePage();
-	allocBuf(frameNo);
-	pageNo = filePage.page_number();
-	
-	///insert into hashtable then set frame
-	hashTable->insert(file, pageNo, frameNo);
-	bufDescTable[frameNo].Set(file, pageNo);
-	bufPool[frameNo] = filePage;
-	///passs correct pointer
-    page = &bufPool[frameNo];
-	
+    throwIfFailed(tryFetchPage(file, pageNo, page, NULL), file, pageNo);
+}
 
+/**
+ *  readPage that reports a missing page or a full pool as a status
+ * Input: file pointer, pageNo, address of page(for reference return)
+ * Output: Status::OK with the page address, or what went wrong
+ */
+Status BufMgr::tryReadPage(File* file, const PageId pageNo, Page*& page)
+{
+    return tryFetchPage(file, pageNo, page, NULL);
+}
 
+/**
+ *  Read a page for a scan, reusing the ring's frames for misses instead of the policy's victims
+ * Input: file pointer, pageNo, address of page(for reference return), ring
+ * Outpu: Returns the address of a page for reading
+ */
+void BufMgr::readPage(File* file, const PageId pageNo, Page*& page, BufferRing& ring)
+{
+    throwIfFailed(tryFetchPage(file, pageNo, page, &ring), file, pageNo);
 }
 
 /**
- *  Clears files from the buffer table. The important part of this function is to write to disk the changed pages.
- *  If the page is not valid or if the page is pinned then this will cause exceptions to be thrown.
- * Input: file pointer
- * Outpu: N/A
+ *  Find a resident, unpinned page and note its frame's version, without pinning it. Nothing
+ *  shared is written: neither the policy nor the statistics hear of the read.
+ * Input: file pointer, pageNo, handle(for reference return)
+ * Output: true if the page was found
  */
-void BufMgr::flushFile(const File* file) 
+bool BufMgr::readPageOptimistic(File* file, const PageId pageNo, OptimisticPage& handle)
 {
-    for(uint32_t i = 0; i < numBufs; i++){
-        //check to see if the entry is from this file
-        if(file == bufDescTable[i].file){
-          
-            //before proceeding, check valid bit and pinned
-            if(!bufDescTable[i].valid){
-        	  throw BadBufferException(i, bufDescTable[i].dirty, bufDescTable[i].valid, bufDescTable[i].refbit);
-            }else if(bufDescTable[i].pinCnt > 0) {
-           	  throw PagePinnedException(file->filename(), bufDescTable[i].pageNo, i);
-		 }
-            ///Check for dirty page which will need to be written to disk
-            if (bufDescTable[i].dirty){
-                
-                bufDescTable[i].file->writePage(bufPool[i]);
-                bufDescTable[i].dirty = false;
-            }
-            ///remove the page and clear the buffer
-            hashTable->remove(file, bufDescTable[i].pageNo);
-            
-            bufDescTable[i].Clear();
-            
+    FrameId frameNo;
+    {
+        ///the latch only keeps the slots still while we probe; the frame is checked by its version
+        std::lock_guard<std::mutex> partitionGuard(hashTable->partitionLatch(file, pageNo));
+        if (!hashTable->tryLookup(file, pageNo, frameNo)) {
+            return false;
         }
     }
+    if (!bufDescTable[frameNo].heldVersion(file->id(), pageNo, handle.version)) {
+        return false;
+    }
+    handle.page = &bufPool[frameNo];
+    handle.frame = frameNo;
+    return true;
 }
 
 /**
- * Dispose Page deletes the page from the hashtable if it is present but also deletes the page in the file.
- * If it is not in hashtable then ignores the table and only removes the page from the file.
- * Input: file pointer, pageNo
- * Outpu: N/A
+ *  Find a page optimistically through a reference, taking no latch at all while the frame it is
+ *  swizzled to still holds the page
+ * Input: reference, handle(for reference return)
+ * Output: true if the page was found; the reference is left swizzled to its frame
  */
-void BufMgr::disposePage(File* file, const PageId PageNo)
+bool BufMgr::readPageOptimistic(PageRef& ref, OptimisticPage& handle)
 {
-	FrameId frameNo = 0;
-    /// if allocated in buffer pool, free it
-    try {
-        hashTable->lookup(file, PageNo, frameNo);
-        /// remove page from hash table
-        bufDescTable[frameNo].Clear();
-        
-        hashTable->remove(file, PageNo);
+    const FrameId frame = ref.frame.load(std::memory_order_relaxed);
+    if (frame != PageRef::UNSWIZZLED &&
+        bufDescTable[frame].heldVersion(ref.file->id(), ref.pageNo, handle.version)) {
+        handle.page = &bufPool[frame];
+        handle.frame = frame;
+        return true;
     }
-    catch (const HashNotFoundException& e) {
-        /// not in hash table, shouldn't need to do anything
+    if (!readPageOptimistic(ref.file, ref.pageNo, handle)) {
+        return false;
     }
-
-    file->deletePage(PageNo);
+    ref.frame.store(handle.frame, std::memory_order_relaxed);
+    return true;
 }
 
+///readPage, with misses going through the ring when there is one
+Status BufMgr::tryFetchPage(File* file, const PageId pageNo, Page*& page, BufferRing* ring)
+{
+    std::mutex& partition = hashTable->partitionLatch(file, pageNo);
+    bufStats.add(BufCounter::ACCESSES, file);
+    ///only a failed prefetch sends us round again, and the retry then reads the page itself
+    for (;;) {
+        FrameId frameNo;
+        /// check whether page is already in buffer pool
+        bool resident = false;
+        {
+            std::lock_guard<std::mutex> partitionGuard(partition);
+            if (hashTable->tryLookup(file, pageNo, frameNo)) {
+                /// increment pin count and let the policy see the reference
+                pinResident(frameNo);
+                policy->accessed(frameNo);
+                resident = true;
+            }
+        }
+        if (resident) {
+            if (awaitLoad(frameNo, file, pageNo)) {
+                bufStats.add(BufCounter::HITS, file);
+                /// return pointer to frame containing the page via page parameter
+                page = &bufPool[frameNo];
+                return Status::OK;
+            }
+            continue;
+        }
+        /// not in buffer pool, need to add to buffer
+
+        /// allocate buffer frame
+        Status status = ring != NULL ? tryAllocRingBuf(*ring, frameNo, file) : tryAllocBuf(frameNo, file);
+        if (status != Status::OK) {
+            return status;
+        }
+        /// add to bufPool
+        try {
+            status = loadFrame(file, pageNo, frameNo);
+        }
+        catch (...) {
+            releaseBuf(frameNo);
+            throw;
+        }
+        if (status != Status::OK) {
+            releaseBuf(frameNo);
+            return status;
+        }
+        bufStats.add(BufCounter::MISSES, file);
+
+        {
+            std::lock_guard<std::mutex> partitionGuard(partition);
+            FrameId loadedFrame;
+            if (!hashTable->tryLookup(file, pageNo, loadedFrame)) {
+                /// set the description table
+                {
+                    std::lock_guard<std::mutex> descGuard(bufDescTable[frameNo].latch);
+                    bufDescTable[frameNo].Set(file, pageNo);
+                    linkFrame(frameNo, file);
+                    policy->loaded(frameNo, file, pageNo);
+                }
+                /// insert page into hash table
+                hashTable->insert(file, pageNo, frameNo);
+                if (ring != NULL) {
+                    ringLoaded(*ring, frameNo, file, pageNo);
+                }
+                /// return the page pointer
+                page = &bufPool[frameNo];
+                return Status::OK;
+            }
+
+            /// another thread read the same page while we were; use its frame and drop ours
+            releaseBuf(frameNo);
+
+            pinResident(loadedFrame);
+            policy->accessed(loadedFrame);
+            frameNo = loadedFrame;
+        }
+        if (awaitLoad(frameNo, file, pageNo)) {
+            page = &bufPool[frameNo];
+            return Status::OK;
+        }
+    }
+}
+
+///the tiers only hold clean pages, so their copies are as good as the file's
+Status BufMgr::loadFrame(File* file, const PageId pageNo, const FrameId frame)
+{
+    if(takeFromTiers(file, pageNo, frame)){
+        return Status::OK;
+    }
+    Status status;
+    {
+        std::lock_guard<std::mutex> ioGuard(ioLatch);
+        status = file->tryReadPage(pageNo, bufPool[frame]);
+    }
+    if(status == Status::OK){
+        bufStats.add(BufCounter::DISK_READS, file);
+    }
+    return status;
+}
+
+///a page found in one tier is dropped from the other, which may hold an older copy
+bool BufMgr::takeFromTiers(File* file, const PageId pageNo, const FrameId frame)
+{
+    ///an eviction may still be writing the page's copy to the cache file
+    if(secondaryCache != NULL){
+        awaitAdmission(file->id(), pageNo);
+    }
+    if(compressedTier != NULL && compressedTier->take(file->id(), pageNo, bufPool[frame].bytes_)){
+        if(secondaryCache != NULL){
+            secondaryCache->drop(file->filename(), pageNo);
+        }
+        bufStats.add(BufCounter::COMPRESSED_HITS, file);
+        return true;
+    }
+    if(secondaryCache != NULL && secondaryCache->take(file->filename(), pageNo, bufPool[frame].bytes_)){
+        bufStats.add(BufCounter::SECONDARY_HITS, file);
+        return true;
+    }
+    return false;
+}
+
+/**
+ *  Set up, or with a capacity of 0 remove, the compressed tier under the pool
+ * Input: most bytes the compressed copies may take up
+ * Output: N/A
+ */
+void BufMgr::enableCompressedTier(const std::size_t capacity)
+{
+    delete compressedTier;
+    compressedTier = capacity == 0 ? NULL : new CompressedTier(capacity);
+}
+
+/**
+ *  Set up, or with 0 pages remove, the secondary cache under the compressed tier
+ * Input: name of the cache file, number of pages it holds
+ * Output: N/A
+ */
+void BufMgr::enableSecondaryCache(const std::string& path, const std::size_t numPages)
+{
+    delete secondaryCache;
+    secondaryCache = NULL;
+    if(numPages > 0){
+        secondaryCache = new SecondaryCache(path, numPages);
+    }
+}
+
+/**
+ *  Set the loop the asynchronous calls run their I/O through
+ * Input: loop supplied by the caller, or NULL
+ * Output: N/A
+ */
+void BufMgr::setEventLoop(EventLoop* loop)
+{
+    eventLoop = loop;
+}
+
+///under the partition latch a hashed, valid page stays in its frame, so no wait is needed
+bool BufMgr::pinIfLoaded(File* file, const PageId pageNo, Page*& page)
+{
+    FrameId frameNo;
+    {
+        std::lock_guard<std::mutex> partitionGuard(hashTable->partitionLatch(file, pageNo));
+        if (!hashTable->tryLookup(file, pageNo, frameNo) || !bufDescTable[frameNo].valid()) {
+            return false;
+        }
+        pinResident(frameNo);
+        policy->accessed(frameNo);
+    }
+    bufStats.add(BufCounter::ACCESSES, file);
+    bufStats.add(BufCounter::HITS, file);
+    page = &bufPool[frameNo];
+    return true;
+}
+
+/**
+ *  readPage for coroutines: a hit returns at once, anything else is read through the event loop
+ * Input: file pointer, pageNo
+ * Output: task giving the address of the pinned page
+ */
+Task<Page*> BufMgr::readPageAsync(File* file, const PageId pageNo)
+{
+    Page* page;
+    if (pinIfLoaded(file, pageNo, page)) {
+        co_return page;
+    }
+    co_await Offload(eventLoop, [this, file, pageNo, &page]() { readPage(file, pageNo, page); });
+    co_return page;
+}
+
+/**
+ *  allocPage for coroutines, run through the event loop
+ * Input: file pointer, pageNo(for reference return)
+ * Output: task giving the address of the new page
+ */
+Task<Page*> BufMgr::allocPageAsync(File* file, PageId& pageNo)
+{
+    Page* page;
+    co_await Offload(eventLoop, [this, file, &pageNo, &page]() { allocPage(file, pageNo, page); });
+    co_return page;
+}
+
+/**
+ *  flushFile for coroutines, run through the event loop
+ * Input: file pointer
+ * Output: task that is done once the file is flushed
+ */
+Task<void> BufMgr::flushFileAsync(const File* file)
+{
+    co_await Offload(eventLoop, [this, file]() { flushFile(file); });
+}
+
+/**
+ *  Wait for a prefetch of a frame the caller has just pinned to finish.
+ *  If the prefetch failed, the caller's pin is dropped again.
+ * Input: frame number, file pointer, pageNo the frame was found under
+ * Output: true if the frame now holds the page
+ */
+bool BufMgr::awaitLoad(const FrameId frame, File* file, const PageId pageNo)
+{
+    BufDesc& desc = bufDescTable[frame];
+    std::unique_lock<std::mutex> descGuard(desc.latch);
+    if (desc.ioBusy() && !desc.valid()) {
+        bufStats.add(BufCounter::PIN_WAITS, file);
+    }
+    while (desc.ioBusy() && !desc.valid()) {
+        ioDone.wait(descGuard);
+    }
+    if (desc.valid()) {
+        return true;
+    }
+
+    ///disposePage clears the frame, pins and all, so only drop our pin if it is still there
+    if (desc.holds(file, pageNo)) {
+        unpinFrame(frame);
+        if (desc.pinCnt() == 0) {
+            unlinkFrame(frame);
+            desc.Clear();
+        }
+    }
+    return false;
+}
+    
+/**
+ *  updates the descTable to correlate with a page that is no longer pinned in the buffer
+ *  Throws exception if the page is not pinned. Does not throw anything if the page is not in the buffer
+ * Input: file pointer, pageNo, boolean dirty
+ * Outpu: N/A
+ */
+void BufMgr::unPinPage(File* file, const PageId pageNo, const bool dirty) 
+{
+	FrameId frameNo = 0;		
+	{
+		std::lock_guard<std::mutex> partitionGuard(hashTable->partitionLatch(file, pageNo));
+		///check hashtable for page
+		if (!hashTable->tryLookup(file, pageNo, frameNo)){
+			return;
+		}
+
+		unpinResident(frameNo, file, pageNo, dirty);
+	}
+
+	///with no latches held, give the background writer a chance to catch up
+	if(dirty){
+		throttleDirtier(file);
+	}
+}
+
+/**
+ *  Read a page and give it a priority while it is still pinned
+ * Input: file pointer, pageNo, address of page(for reference return), priority
+ * Output: Returns the address of the page
+ */
+void BufMgr::readPage(File* file, const PageId pageNo, Page*& page, const PagePriority priority)
+{
+    readPage(file, pageNo, page);
+    setPriority(file, pageNo, priority);
+}
+
+/**
+ *  Change how hard the pool tries to keep a resident page. A sticky frame is pinned as far as the
+ *  policy knows, so the policy hears of it only when its pin count is zero.
+ * Input: file pointer, pageNo, new priority
+ * Output: false if the page is not resident
+ */
+bool BufMgr::setPriority(const File* file, const PageId pageNo, const PagePriority priority)
+{
+    std::lock_guard<std::mutex> partitionGuard(hashTable->partitionLatch(file, pageNo));
+    FrameId frameNo;
+    if(!hashTable->tryLookup(file, pageNo, frameNo)){
+        return false;
+    }
+    BufDesc& desc = bufDescTable[frameNo];
+    std::lock_guard<std::mutex> descGuard(desc.latch);
+    ///a page still being prefetched has nothing to keep yet
+    if(!desc.valid()){
+        return false;
+    }
+    const bool wasSticky = desc.priority == PagePriority::STICKY;
+    const bool sticky = priority == PagePriority::STICKY;
+    desc.priority = priority;
+    desc.chances = priority == PagePriority::HIGH ? BufDesc::HIGH_CHANCES : 0;
+    if(sticky != wasSticky && desc.pinCnt() == 0){
+        if(sticky){
+            policy->pinned(frameNo);
+        }else{
+            policy->unpinned(frameNo);
+        }
+    }
+    return true;
+}
+
+/**
+ *  Read a page and hand its pin to a guard, which knows the frame and so never needs the hash table
+ * Input: file pointer, pageNo
+ * Output: guard holding the pinned page
+ */
+PageGuard BufMgr::readPage(File* file, const PageId pageNo)
+{
+    Page* pinnedPage;
+    readPage(file, pageNo, pinnedPage);
+    return PageGuard(this, pinnedPage - bufPool, file, pageNo);
+}
+
+/**
+ *  Read a page through a reference, skipping the hash table while its frame still holds the page
+ * Input: reference, address of page(for reference return)
+ * Output: returns the page address and leaves the reference swizzled to its frame
+ */
+void BufMgr::readPage(PageRef& ref, Page*& page)
+{
+    const FrameId frame = ref.frame.load(std::memory_order_relaxed);
+    if(frame != PageRef::UNSWIZZLED){
+        ///pinning under the descriptor latch alone is enough: eviction rechecks the pin count
+        ///before it unhashes the page, and a frame that changed pages no longer matches
+        BufDesc& desc = bufDescTable[frame];
+        std::lock_guard<std::mutex> descGuard(desc.latch);
+        if(desc.valid() && desc.holds(ref.file, ref.pageNo)){
+            pinFrame(frame);
+            policy->accessed(frame);
+            bufStats.add(BufCounter::ACCESSES, ref.file);
+            bufStats.add(BufCounter::HITS, ref.file);
+            page = &bufPool[frame];
+            return;
+        }
+    }
+    ref.frame.store(PageRef::UNSWIZZLED, std::memory_order_relaxed);
+    readPage(ref.file, ref.pageNo, page);
+    ref.frame.store(page - bufPool, std::memory_order_relaxed);
+}
+
+/**
+ *  Unpin a page read through a reference, by its frame while that still holds the page
+ * Input: reference, boolean dirty
+ * Output: N/A
+ */
+void BufMgr::unPinPage(const PageRef& ref, const bool dirty)
+{
+    const FrameId frame = ref.frame.load(std::memory_order_relaxed);
+    if(frame != PageRef::UNSWIZZLED){
+        BufDesc& desc = bufDescTable[frame];
+        std::unique_lock<std::mutex> descGuard(desc.latch);
+        if(desc.valid() && desc.holds(ref.file, ref.pageNo)){
+            if(desc.pinCnt() == 0){
+                throw PageNotPinnedException(ref.file->filename(), ref.pageNo, frame);
+            }
+            if(dirty && desc.setFlag(BufDesc::DIRTY)){
+                dirtyFrames++;
+            }
+            unpinFrame(frame);
+            descGuard.unlock();
+            if(dirty){
+                throttleDirtier(ref.file);
+            }
+            return;
+        }
+    }
+    unPinPage(ref.file, ref.pageNo, dirty);
+}
+
+/**
+ *  Pin a batch of pages. Hits are found partition by partition, then every miss gets a frame and
+ *  all the misses are read in one go, in file and page order.
+ * Input: array of (file pointer, pageNo), its length, array for the page addresses
+ * Output: page addresses returned through pages; on an exception nothing is left pinned
+ */
+void BufMgr::readPages(const PageKey* keys, const std::size_t n, Page** pages)
+{
+    std::vector<std::mutex*> latches;
+    std::vector<std::size_t> order;
+    batchOrder(keys, n, latches, order);
+
+    const auto sameKey = [keys](const std::size_t a, const std::size_t b) {
+        return keys[a].file->id() == keys[b].file->id() && keys[a].pageNo == keys[b].pageNo;
+    };
+
+    ///every pin taken and every frame reserved so far, so that a failure can give them all back
+    std::vector<FrameId> pinned;
+    std::vector<FrameId> reserved;
+    std::vector<std::size_t> misses;
+    std::vector<std::size_t> loading;
+    try {
+        ///one pass over the hash table, taking each partition latch once
+        std::size_t i = 0;
+        while(i < n){
+            std::mutex* latch = latches[order[i]];
+            std::lock_guard<std::mutex> partitionGuard(*latch);
+            for(; i < n && latches[order[i]] == latch; i++){
+                const PageKey& key = keys[order[i]];
+                FrameId frameNo;
+                bufStats.add(BufCounter::ACCESSES, key.file);
+                if(!hashTable->tryLookup(key.file, key.pageNo, frameNo)){
+                    misses.push_back(order[i]);
+                    continue;
+                }
+                pinResident(frameNo);
+                policy->accessed(frameNo);
+                pinned.push_back(frameNo);
+                pages[order[i]] = &bufPool[frameNo];
+                if(!bufDescTable[frameNo].valid()){
+                    loading.push_back(order[i]);
+                }else{
+                    bufStats.add(BufCounter::HITS, key.file);
+                }
+            }
+        }
+
+        ///pages still being prefetched; one whose prefetch failed is read along with the misses
+        for(std::size_t j = 0; j < loading.size(); j++){
+            const PageKey& key = keys[loading[j]];
+            const FrameId frameNo = pages[loading[j]] - bufPool;
+            if(!awaitLoad(frameNo, key.file, key.pageNo)){
+                pinned.erase(std::find(pinned.begin(), pinned.end(), frameNo));
+                misses.push_back(loading[j]);
+            }else{
+                bufStats.add(BufCounter::HITS, key.file);
+            }
+        }
+
+        ///file and page order, with copies of the same page next to each other
+        std::sort(misses.begin(), misses.end(), [keys](const std::size_t a, const std::size_t b) {
+            if(keys[a].file->id() != keys[b].file->id())
+                return keys[a].file->id() < keys[b].file->id();
+            return keys[a].pageNo < keys[b].pageNo;
+        });
+
+        ///a frame for every distinct page first, so that the reads can all be issued together
+        for(std::size_t j = 0; j < misses.size(); j++){
+            if(j == 0 || !sameKey(misses[j - 1], misses[j])){
+                FrameId frameNo;
+                allocBuf(frameNo, keys[misses[j]].file);
+                reserved.push_back(frameNo);
+            }
+        }
+        ///pages the tiers hold first, then the rest from disk together
+        std::vector<bool> fromTier(reserved.size(), false);
+        if(compressedTier != NULL || secondaryCache != NULL){
+            std::size_t next = 0;
+            for(std::size_t j = 0; j < misses.size(); j++){
+                if(j == 0 || !sameKey(misses[j - 1], misses[j])){
+                    const PageKey& key = keys[misses[j]];
+                    fromTier[next] = takeFromTiers(key.file, key.pageNo, reserved[next]);
+                    next++;
+                }
+            }
+        }
+        {
+            std::lock_guard<std::mutex> ioGuard(ioLatch);
+            std::size_t next = 0;
+            for(std::size_t j = 0; j < misses.size(); j++){
+                if(j == 0 || !sameKey(misses[j - 1], misses[j])){
+                    if(!fromTier[next]){
+                        keys[misses[j]].file->readPage(keys[misses[j]].pageNo, bufPool[reserved[next]]);
+                        bufStats.add(BufCounter::DISK_READS, keys[misses[j]].file);
+                    }
+                    next++;
+                }
+                bufStats.add(BufCounter::MISSES, keys[misses[j]].file);
+            }
+        }
+
+        ///hash the new pages, last first, so that reserved only ever shrinks from the back
+        std::size_t end = misses.size();
+        while(end > 0){
+            std::size_t begin = end - 1;
+            while(begin > 0 && sameKey(misses[begin - 1], misses[begin])){
+                begin--;
+            }
+            const PageKey& key = keys[misses[begin]];
+            const FrameId frameNo = reserved.back();
+
+            bool raced;
+            {
+                std::lock_guard<std::mutex> partitionGuard(hashTable->partitionLatch(key.file, key.pageNo));
+                FrameId loadedFrame;
+                raced = hashTable->tryLookup(key.file, key.pageNo, loadedFrame);
+                if(raced){
+                    releaseBuf(frameNo);
+                }else{
+                    std::lock_guard<std::mutex> descGuard(bufDescTable[frameNo].latch);
+                    bufDescTable[frameNo].Set(key.file, key.pageNo);
+                    linkFrame(frameNo, key.file);
+                    policy->loaded(frameNo, key.file, key.pageNo);
+                    hashTable->insert(key.file, key.pageNo, frameNo);
+                    for(std::size_t j = begin; j < end; j++){
+                        if(j > begin){
+                            pinFrame(frameNo);
+                        }
+                        pinned.push_back(frameNo);
+                        pages[misses[j]] = &bufPool[frameNo];
+                    }
+                }
+            }
+            reserved.pop_back();
+
+            ///another thread read the page meanwhile; pin its copy the ordinary way
+            if(raced){
+                for(std::size_t j = begin; j < end; j++){
+                    readPage(key.file, key.pageNo, pages[misses[j]]);
+                    pinned.push_back(pages[misses[j]] - bufPool);
+                }
+            }
+            end = begin;
+        }
+    }
+    catch (...) {
+        for(std::size_t j = 0; j < reserved.size(); j++){
+            releaseBuf(reserved[j]);
+        }
+        for(std::size_t j = 0; j < pinned.size(); j++){
+            std::lock_guard<std::mutex> descGuard(bufDescTable[pinned[j]].latch);
+            unpinFrame(pinned[j]);
+        }
+        throw;
+    }
+}
+
+/**
+ *  Unpin a batch of pages, taking each partition latch once
+ *  Throws exception if a page is not pinned. Pages not in the buffer are skipped
+ * Input: array of (file pointer, pageNo), its length, boolean dirty
+ * Output: N/A
+ */
+void BufMgr::unPinPages(const PageKey* keys, const std::size_t n, const bool dirty)
+{
+    std::vector<std::mutex*> latches;
+    std::vector<std::size_t> order;
+    batchOrder(keys, n, latches, order);
+
+    std::size_t i = 0;
+    while(i < n){
+        std::mutex* latch = latches[order[i]];
+        std::lock_guard<std::mutex> partitionGuard(*latch);
+        for(; i < n && latches[order[i]] == latch; i++){
+            const PageKey& key = keys[order[i]];
+            FrameId frameNo;
+            if(!hashTable->tryLookup(key.file, key.pageNo, frameNo)){
+                continue;
+            }
+            unpinResident(frameNo, key.file, key.pageNo, dirty);
+        }
+    }
+
+    if(dirty && n > 0){
+        throttleDirtier(keys[0].file);
+    }
+}
+
+///sort a batch by partition latch, then file and page, remembering each key's latch
+void BufMgr::batchOrder(const PageKey* keys, const std::size_t n, std::vector<std::mutex*>& latches,
+                        std::vector<std::size_t>& order)
+{
+    latches.resize(n);
+    order.resize(n);
+    for(std::size_t i = 0; i < n; i++){
+        latches[i] = &hashTable->partitionLatch(keys[i].file, keys[i].pageNo);
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [keys, &latches](const std::size_t a, const std::size_t b) {
+        if(latches[a] != latches[b])
+            return std::less<std::mutex*>()(latches[a], latches[b]);
+        if(keys[a].file->id() != keys[b].file->id())
+            return keys[a].file->id() < keys[b].file->id();
+        return keys[a].pageNo < keys[b].pageNo;
+    });
+}
+
+/**
+ *  create a page within a file when one does not already exist
+ *  Add to buffer since it is newly created and this is a form of access
+ * Input: file pointer, pageNo, address of page(for reference return)
+ * Output: returns a page address that is now allocated
+ */
+void BufMgr::allocPage(File* file, PageId &pageNo, Page*& page) 
+{
+	throwIfFailed(tryAllocPage(file, pageNo, page), file, Page::INVALID_NUMBER);
+}
+
+/**
+ *  allocPage that reports a full pool as a status. The frame is reserved before the file grows,
+ *  so a full pool does not leave a page behind in the file.
+ * Input: file pointer, pageNo, address of page(for reference return)
+ * Output: Status::OK with the page address, or Status::BUFFER_EXCEEDED
+ */
+Status BufMgr::tryAllocPage(File* file, PageId &pageNo, Page*& page)
+{
+	FrameId frameNo;		
+	///get buffer frame pool and then allocate page
+	const Status status = tryAllocBuf(frameNo, file);
+	if(status != Status::OK){
+		return status;
+	}
+	Page filePage;
+	try {
+		std::lock_guard<std::mutex> ioGuard(ioLatch);
+		filePage = file->allocatePage();
+	}
+	catch (...) {
+		releaseBuf(frameNo);
+		throw;
+	}
+	pageNo = filePage.page_number();
+	///a file deleted and made again reuses page numbers the cache file may still hold
+	if(secondaryCache != NULL){
+		awaitAdmission(file->id(), pageNo);
+		secondaryCache->drop(file->filename(), pageNo);
+	}
+	bufStats.add(BufCounter::ACCESSES, file);
+	bufStats.add(BufCounter::ALLOCS, file);
+	bufStats.add(BufCounter::DISK_READS, file);
+	bufPool[frameNo] = filePage;
+	
+	///set frame then insert into hashtable
+	std::lock_guard<std::mutex> partitionGuard(hashTable->partitionLatch(file, pageNo));
+	{
+		std::lock_guard<std::mutex> descGuard(bufDescTable[frameNo].latch);
+		bufDescTable[frameNo].Set(file, pageNo);
+		linkFrame(frameNo, file);
+		policy->loaded(frameNo, file, pageNo);
+	}
+	hashTable->insert(file, pageNo, frameNo);
+	///passs correct pointer
+    page = &bufPool[frameNo];
+	return Status::OK;
+}
+
+/**
+ *  Allocate a page and give it a priority while it is still pinned
+ * Input: file pointer, pageNo(for reference return), address of page(for reference return), priority
+ * Output: returns a page address that is now allocated
+ */
+void BufMgr::allocPage(File* file, PageId &pageNo, Page*& page, const PagePriority priority)
+{
+    allocPage(file, pageNo, page);
+    setPriority(file, pageNo, priority);
+}
+
+/**
+ *  Allocate a page and hand its pin to a guard
+ * Input: file pointer, pageNo(for reference return)
+ * Output: guard holding the new page
+ */
+PageGuard BufMgr::allocPage(File* file, PageId &pageNo)
+{
+    Page* pinnedPage;
+    allocPage(file, pageNo, pinnedPage);
+    return PageGuard(this, pinnedPage - bufPool, file, pageNo);
+}
+
+/**
+ *  Unpin by frame for a PageGuard. A frame that no longer holds the page was disposed of and
+ *  may belong to someone else by now, so it is left alone.
+ * Input: frame number, file pointer, pageNo, boolean dirty
+ * Output: N/A
+ */
+void BufMgr::unPinFrame(const FrameId frame, const File* file, const PageId pageNo, const bool dirty)
+{
+    {
+        BufDesc& desc = bufDescTable[frame];
+        std::lock_guard<std::mutex> descGuard(desc.latch);
+        if(!desc.holds(file, pageNo) || desc.pinCnt() == 0){
+            return;
+        }
+        if(dirty && desc.setFlag(BufDesc::DIRTY)){
+            dirtyFrames++;
+        }
+        unpinFrame(frame);
+    }
+
+    if(dirty){
+        throttleDirtier(file);
+    }
+}
+
+/**
+ *  Clears files from the buffer table. The important part of this function is to write to disk the changed pages.
+ *  If the page is not valid or if the page is pinned then this will cause exceptions to be thrown.
+ * Input: file pointer
+ * Outpu: N/A
+ */
+void BufMgr::flushFile(const File* file) 
+{
+    evictFile(file, true);
+}
+
+/**
+ *  Drops the pages of a file that is going away, dirty or not
+ *  Throws exception if a page is pinned
+ * Input: file pointer
+ * Output: N/A
+ */
+void BufMgr::invalidateFile(const File* file)
+{
+    evictFile(file, false);
+    if(secondaryCache != NULL){
+        awaitAdmission(file->id(), Page::INVALID_NUMBER);
+        secondaryCache->dropFile(file->filename());
+    }
+}
+
+/**
+ *  Counts the pages of a file in the buffer pool from the file's frame list
+ * Input: file pointer
+ * Output: number of resident pages
+ */
+std::uint32_t BufMgr::residentPages(const File* file)
+{
+    std::lock_guard<std::mutex> indexGuard(fileIndexLatch);
+    std::unordered_map<FileId, FileFrames>::const_iterator it = fileFrames.find(file->id());
+    return it == fileFrames.end() ? 0 : it->second.count;
+}
+
+///groups are numbered in the order they are first named
+std::uint32_t BufMgr::groupNumber(const std::string& group)
+{
+    std::unordered_map<std::string, std::uint32_t>::const_iterator it = groupNumbers.find(group);
+    if(it != groupNumbers.end()){
+        return it->second;
+    }
+    quotas.push_back(FrameQuota());
+    groupNumbers[group] = quotas.size() - 1;
+    return quotas.size() - 1;
+}
+
+/**
+ *  Move a file to a group, carrying the count of its resident pages with it
+ * Input: file pointer, group name
+ * Output: N/A
+ */
+void BufMgr::setFileGroup(const File* file, const std::string& group)
+{
+    std::lock_guard<std::mutex> indexGuard(fileIndexLatch);
+    const std::uint32_t number = groupNumber(group);
+    std::unordered_map<FileId, std::uint32_t>::iterator grouped = fileGroups.find(file->id());
+    if(grouped != fileGroups.end()){
+        std::vector<FileId>& files = quotas[grouped->second].files;
+        files.erase(std::find(files.begin(), files.end(), file->id()));
+    }
+    quotas[number].files.push_back(file->id());
+    fileGroups[file->id()] = number;
+    std::unordered_map<FileId, FileFrames>::iterator it = fileFrames.find(file->id());
+    if(it != fileFrames.end()){
+        if(it->second.group != NO_GROUP){
+            quotas[it->second.group].frames -= it->second.count;
+        }
+        quotas[number].frames += it->second.count;
+        it->second.group = number;
+    }
+}
+
+/**
+ *  Set the reservation and quota of a group. Pages over a lowered quota are evicted by later misses.
+ * Input: group name, frames reserved, most frames
+ * Output: N/A
+ */
+void BufMgr::setQuota(const std::string& group, const std::uint32_t minFrames, const std::uint32_t maxFrames)
+{
+    if(maxFrames == 0 || minFrames > maxFrames){
+        throw InvalidQuotaException(group, minFrames, maxFrames);
+    }
+    std::lock_guard<std::mutex> indexGuard(fileIndexLatch);
+    FrameQuota& quota = quotas[groupNumber(group)];
+    quota.minFrames = minFrames;
+    quota.maxFrames = maxFrames;
+    bool limited = false;
+    bool reserved = false;
+    for(std::size_t i = 0; i < quotas.size(); i++){
+        limited = limited || quotas[i].minFrames > 0 || quotas[i].maxFrames != FrameQuota().maxFrames;
+        reserved = reserved || quotas[i].minFrames > 0;
+    }
+    anyQuota.store(limited);
+    anyReservation.store(reserved);
+}
+
+///a file's own group carries its name
+void BufMgr::setQuota(const File* file, const std::uint32_t minFrames, const std::uint32_t maxFrames)
+{
+    if(maxFrames == 0 || minFrames > maxFrames){
+        throw InvalidQuotaException(file->filename(), minFrames, maxFrames);
+    }
+    setFileGroup(file, file->filename());
+    setQuota(file->filename(), minFrames, maxFrames);
+}
+
+///frames counted against the group
+std::uint32_t BufMgr::groupFrames(const std::string& group)
+{
+    std::lock_guard<std::mutex> indexGuard(fileIndexLatch);
+    std::unordered_map<std::string, std::uint32_t>::const_iterator it = groupNumbers.find(group);
+    return it == groupNumbers.end() ? 0 : quotas[it->second].frames;
+}
+
+///the group a miss evicts from, if quotas decide it
+std::uint32_t BufMgr::shrinkingGroup(const File* file, std::uint32_t& ownGroup)
+{
+    ownGroup = NO_GROUP;
+    if(!anyQuota.load(std::memory_order_relaxed)){
+        return NO_GROUP;
+    }
+    std::lock_guard<std::mutex> indexGuard(fileIndexLatch);
+    if(file != NULL){
+        std::unordered_map<FileId, std::uint32_t>::const_iterator it = fileGroups.find(file->id());
+        if(it != fileGroups.end()){
+            ownGroup = it->second;
+            if(quotas[ownGroup].frames >= quotas[ownGroup].maxFrames){
+                return ownGroup;
+            }
+        }
+    }
+    for(std::uint32_t g = 0; g < quotas.size(); g++){
+        if(quotas[g].frames > quotas[g].maxFrames){
+            return g;
+        }
+    }
+    return NO_GROUP;
+}
+
+///visit only the frames on the file's list; each is checked again under its latches
+void BufMgr::evictFile(const File* file, const bool writeBack)
+{
+    ///no prefetch of this file may land in the pool behind our back
+    cancelPrefetches(file);
+
+    std::vector<FrameId> frames;
+    {
+        std::lock_guard<std::mutex> indexGuard(fileIndexLatch);
+        std::unordered_map<FileId, FileFrames>::const_iterator it = fileFrames.find(file->id());
+        if(it != fileFrames.end()){
+            frames.reserve(it->second.count);
+            for(FrameId f = it->second.head; f != BufDesc::INVALID_FRAME; f = bufDescTable[f].fileNext){
+                frames.push_back(f);
+            }
+        }
+    }
+
+    ///dirty pages to write back together at the end, held pinned and ioBusy until they are
+    std::vector<std::pair<PageId, FrameId> > pending;
+    try {
+        for(std::size_t j = 0; j < frames.size(); j++){
+            const FrameId i = frames[j];
+            BufDesc& desc = bufDescTable[i];
+            PageId pageNo;
+            //check to see if the entry is still from this file
+            {
+                std::lock_guard<std::mutex> descGuard(desc.latch);
+                if(desc.fileId != file->id()){
+                    continue;
+                }
+                pageNo = desc.pageNo;
+            }
+
+            std::lock_guard<std::mutex> partitionGuard(hashTable->partitionLatch(file, pageNo));
+            std::unique_lock<std::mutex> descGuard(desc.latch);
+            ///frame was handed to another page while we were not holding its latch
+            if(!desc.holds(file, pageNo)){
+                continue;
+            }
+            ///the background writer holds a pin while it writes; the partition latch keeps the page here
+            if(desc.ioBusy()){
+                bufStats.add(BufCounter::PIN_WAITS, file);
+            }
+            while(desc.ioBusy()){
+                ioDone.wait(descGuard);
+            }
+
+            //before proceeding, check valid bit and pinned
+            if(!desc.valid()){
+                throw BadBufferException(i, desc.dirty(), desc.valid(), false);
+            }else if(desc.pinCnt() > 0) {
+                throw PagePinnedException(file->filename(), desc.pageNo, i);
+            }
+            ///Check for dirty page which will need to be written to disk
+            if (desc.clearFlag(BufDesc::DIRTY)){
+                dirtyFrames--;
+                if(writeBack){
+                    pinFrame(i);
+                    desc.setFlag(BufDesc::IO_BUSY);
+                    pending.push_back(std::make_pair(pageNo, i));
+                    continue;
+                }
+            }
+            ///remove the page and clear the buffer
+            hashTable->remove(file, desc.pageNo);
+            policy->freed(i);
+            if(desc.priority == PagePriority::STICKY){
+                policy->unpinned(i);
+            }
+            unlinkFrame(i);
+            desc.Clear();
+        }
+    }
+    catch (...) {
+        ///pages gathered before the pinned one are still written, as they were when flushed one by one
+        try {
+            writeBackPending(file, pending);
+        }
+        catch (...) {
+        }
+        throw;
+    }
+    writeBackPending(file, pending);
+
+    ///the file may be closed soon, after which its copies would never be asked for again
+    if(compressedTier != NULL){
+        compressedTier->dropFile(file->id());
+    }
+}
+
+///sort by page number and write each run of consecutive pages at once, then sync
+void BufMgr::writeRuns(File* file, std::vector<std::pair<PageId, FrameId> >& pages, std::size_t& written)
+{
+    std::sort(pages.begin(), pages.end());
+    std::vector<const Page*> run;
+    for(std::size_t j = 0; j < pages.size(); j++){
+        run.push_back(&bufPool[pages[j].second]);
+        const bool runEnds = j + 1 == pages.size() || pages[j + 1].first != pages[j].first + 1 ||
+                             run.size() == MAX_WRITE_RUN;
+        if(runEnds){
+            {
+                std::lock_guard<std::mutex> ioGuard(ioLatch);
+                file->writePages(run.data(), run.size());
+            }
+            written += run.size();
+            bufStats.add(BufCounter::DISK_WRITES, file, run.size());
+            run.clear();
+        }
+    }
+    if(!pages.empty()){
+        std::lock_guard<std::mutex> ioGuard(ioLatch);
+        file->sync();
+    }
+}
+
+///write what evictFile gathered, then drop the frames as it would have
+void BufMgr::writeBackPending(const File* file, std::vector<std::pair<PageId, FrameId> >& pending)
+{
+    if(pending.empty()){
+        return;
+    }
+    std::size_t written = 0;
+    std::exception_ptr failure;
+    try {
+        ///a copy of the caller's handle, which shares its stream, to write through
+        File handle(*file);
+        writeRuns(&handle, pending, written);
+    }
+    catch (...) {
+        failure = std::current_exception();
+    }
+    bufStats.add(BufCounter::FLUSH_WRITES, file, written);
+
+    ///end the I/O under the descriptor latch alone, as the writer does; a flush of the same file
+    ///may be waiting on ioDone with a partition latch held
+    for(std::size_t j = 0; j < pending.size(); j++){
+        BufDesc& desc = bufDescTable[pending[j].second];
+        std::lock_guard<std::mutex> descGuard(desc.latch);
+        if(j >= written && desc.setFlag(BufDesc::DIRTY)){
+            dirtyFrames++;
+        }
+        desc.clearFlag(BufDesc::IO_BUSY);
+        unpinFrame(pending[j].second);
+    }
+    ioDone.notify_all();
+
+    for(std::size_t j = 0; j < pending.size(); j++){
+        const PageId pageNo = pending[j].first;
+        const FrameId i = pending[j].second;
+        BufDesc& desc = bufDescTable[i];
+        std::lock_guard<std::mutex> partitionGuard(hashTable->partitionLatch(file, pageNo));
+        std::lock_guard<std::mutex> descGuard(desc.latch);
+        if(!desc.holds(file, pageNo) || !desc.valid() || desc.dirty() ||
+           desc.pinCnt() > 0 || desc.ioBusy()){
+            continue;
+        }
+        hashTable->remove(file, pageNo);
+        policy->freed(i);
+        if(desc.priority == PagePriority::STICKY){
+            policy->unpinned(i);
+        }
+        unlinkFrame(i);
+        desc.Clear();
+    }
+
+    if(failure){
+        std::rethrow_exception(failure);
+    }
+}
+
+///push the frame on the front of its file's list
+void BufMgr::linkFrame(const FrameId frame, const File* file)
+{
+    BufDesc& desc = bufDescTable[frame];
+    std::lock_guard<std::mutex> indexGuard(fileIndexLatch);
+    FileFrames& list = fileFrames[desc.fileId];
+    if(list.count == 0){
+        list.name = file->filename();
+        std::unordered_map<FileId, std::uint32_t>::const_iterator grouped = fileGroups.find(desc.fileId);
+        list.group = grouped == fileGroups.end() ? NO_GROUP : grouped->second;
+    }
+    if(list.group != NO_GROUP){
+        quotas[list.group].frames++;
+    }
+    desc.filePrev = BufDesc::INVALID_FRAME;
+    desc.fileNext = list.head;
+    if(list.head != BufDesc::INVALID_FRAME){
+        bufDescTable[list.head].filePrev = frame;
+    }
+    list.head = frame;
+    list.count++;
+}
+
+///splice the frame out of its file's list, dropping the list when it empties
+void BufMgr::unlinkFrame(const FrameId frame)
+{
+    BufDesc& desc = bufDescTable[frame];
+    if(desc.fileId == File::INVALID_ID){
+        return;
+    }
+    std::lock_guard<std::mutex> indexGuard(fileIndexLatch);
+    std::unordered_map<FileId, FileFrames>::iterator it = fileFrames.find(desc.fileId);
+    if(desc.filePrev != BufDesc::INVALID_FRAME){
+        bufDescTable[desc.filePrev].fileNext = desc.fileNext;
+    }else{
+        it->second.head = desc.fileNext;
+    }
+    if(desc.fileNext != BufDesc::INVALID_FRAME){
+        bufDescTable[desc.fileNext].filePrev = desc.filePrev;
+    }
+    desc.fileNext = desc.filePrev = BufDesc::INVALID_FRAME;
+    if(it->second.group != NO_GROUP){
+        quotas[it->second.group].frames--;
+    }
+    if(--it->second.count == 0){
+        fileFrames.erase(it);
+    }
+}
+
+///the name recorded when the file's first page came into the pool
+std::string BufMgr::residentFileName(const FileId fileId)
+{
+    std::lock_guard<std::mutex> indexGuard(fileIndexLatch);
+    return fileFrames.find(fileId)->second.name;
+}
+
+/**
+ * Dispose Page deletes the page from the hashtable if it is present but also deletes the page in the file.
+ * If it is not in hashtable then ignores the table and only removes the page from the file.
+ * Input: file pointer, pageNo
+ * Outpu: N/A
+ */
+void BufMgr::disposePage(File* file, const PageId PageNo)
+{
+	FrameId frameNo = 0;
+    /// if allocated in buffer pool, free it; if not in hash table, shouldn't need to do anything
+    {
+        std::lock_guard<std::mutex> partitionGuard(hashTable->partitionLatch(file, PageNo));
+        if (hashTable->tryLookup(file, PageNo, frameNo)) {
+            /// remove page from hash table
+            {
+                std::unique_lock<std::mutex> descGuard(bufDescTable[frameNo].latch);
+                if (bufDescTable[frameNo].ioBusy())
+                    bufStats.add(BufCounter::PIN_WAITS, file);
+                while (bufDescTable[frameNo].ioBusy())
+                    ioDone.wait(descGuard);
+                if (bufDescTable[frameNo].dirty())
+                    dirtyFrames--;
+                policy->freed(frameNo);
+                if (bufDescTable[frameNo].pinCnt() > 0 ||
+                    bufDescTable[frameNo].priority == PagePriority::STICKY)
+                    policy->unpinned(frameNo);
+                unlinkFrame(frameNo);
+                bufDescTable[frameNo].Clear();
+            }
+            
+            hashTable->remove(file, PageNo);
+        }
+    }
+
+    if(compressedTier != NULL){
+        compressedTier->drop(file->id(), PageNo);
+    }
+    if(secondaryCache != NULL){
+        awaitAdmission(file->id(), PageNo);
+        secondaryCache->drop(file->filename(), PageNo);
+    }
+    {
+        std::lock_guard<std::mutex> ioGuard(ioLatch);
+        file->deletePage(PageNo);
+    }
+    bufStats.add(BufCounter::DISPOSES, file);
+}
+
+/**
+ *  Start the cleaner thread, replacing one that is already running
+ * Input: number of next victims to keep clean, dirty fraction that turns on throttling, sleep between rounds
+ * Output: N/A
+ */
+void BufMgr::startBackgroundWriter(const std::uint32_t cleanTarget, const double dirtyHighWater,
+                                   const std::chrono::milliseconds interval)
+{
+    stopBackgroundWriter();
+
+    std::lock_guard<std::mutex> writerGuard(writerLatch);
+    writerStop = false;
+    writerKicked = false;
+    writerCleanTarget = cleanTarget;
+    writerDirtyFraction = dirtyHighWater;
+    writerHighWater = static_cast<std::uint32_t>(dirtyHighWater * numBufs.load());
+    writerInterval = interval;
+    writerThread = new std::thread(&BufMgr::backgroundWriterLoop, this);
+}
+
+/**
+ *  Ask the cleaner thread to exit and wait for it. Throttled threads are released.
+ * Input: N/A
+ * Output: N/A
+ */
+void BufMgr::stopBackgroundWriter()
+{
+    std::thread* running;
+    {
+        std::lock_guard<std::mutex> writerGuard(writerLatch);
+        running = writerThread;
+        writerStop = true;
+    }
+    if(running == NULL){
+        return;
+    }
+    writerWake.notify_all();
+    running->join();
+    delete running;
+
+    std::lock_guard<std::mutex> writerGuard(writerLatch);
+    writerThread = NULL;
+    writerRoundDone.notify_all();
+}
+
+///runs rounds until stopped; sleeps between rounds unless kicked or over the high-water mark
+void BufMgr::backgroundWriterLoop()
+{
+    std::unique_lock<std::mutex> writerGuard(writerLatch);
+    while(!writerStop){
+        writerKicked = false;
+        writerGuard.unlock();
+        cleanAhead();
+        writerGuard.lock();
+
+        writerRounds++;
+        writerRoundDone.notify_all();
+        if(dirtyFrames.load() <= writerHighWater){
+            writerWake.wait_for(writerGuard, writerInterval, [this]() { return writerStop || writerKicked; });
+        }
+    }
+}
+
+///write out the dirty pages among the frames the policy would evict next
+void BufMgr::cleanAhead()
+{
+    ///over the high-water mark every unpinned dirty page is fair game
+    const std::size_t wanted = dirtyFrames.load() > writerHighWater ? numBufs.load() : writerCleanTarget;
+    std::vector<FrameId> candidates;
+    policy->evictionCandidates(candidates, wanted);
+
+    for(std::size_t i = 0; i < candidates.size(); i++){
+        writeBehind(candidates[i]);
+    }
+}
+
+/**
+ *  Write a page out from under the replacement policy. The frame is pinned and marked ioBusy
+ *  for the duration so it can be neither evicted nor dropped, but it can still be read.
+ * Input: frame number
+ * Output: true if the page was written
+ */
+bool BufMgr::writeBehind(const FrameId frame)
+{
+    BufDesc& desc = bufDescTable[frame];
+    FileId fileId;
+    std::string fileName;
+    {
+        std::lock_guard<std::mutex> descGuard(desc.latch);
+        if(!desc.valid() || !desc.dirty() || desc.pinCnt() > 0 || desc.ioBusy()){
+            return false;
+        }
+        pinFrame(frame);
+        desc.setFlag(BufDesc::IO_BUSY);
+        ///cleared before the write, so a page dirtied again meanwhile stays dirty
+        desc.clearFlag(BufDesc::DIRTY);
+        dirtyFrames--;
+        fileId = desc.fileId;
+        fileName = residentFileName(fileId);
+    }
+
+    bool written = true;
+    try {
+        File file = File::open(fileName);
+        std::lock_guard<std::mutex> ioGuard(ioLatch);
+        file.writePage(bufPool[frame]);
+    }
+    catch (...) {
+        ///leave the page dirty; a foreground flush or eviction will report the error
+        written = false;
+    }
+
+    if(written){
+        bufStats.add(BufCounter::WRITER_WRITES, fileId, fileName);
+        bufStats.add(BufCounter::DISK_WRITES, fileId, fileName);
+    }
+
+    {
+        std::lock_guard<std::mutex> descGuard(desc.latch);
+        if(!written && desc.setFlag(BufDesc::DIRTY)){
+            dirtyFrames++;
+        }
+        desc.clearFlag(BufDesc::IO_BUSY);
+        unpinFrame(frame);
+    }
+    ioDone.notify_all();
+    return written;
+}
+
+///cut the writer's sleep short
+void BufMgr::kickWriter()
+{
+    {
+        std::lock_guard<std::mutex> writerGuard(writerLatch);
+        if(writerThread == NULL){
+            return;
+        }
+        writerKicked = true;
+    }
+    writerWake.notify_one();
+}
+
+///hold back a thread that dirtied a page while too much of the pool is dirty
+void BufMgr::throttleDirtier(const File* file)
+{
+    std::unique_lock<std::mutex> writerGuard(writerLatch);
+    if(writerThread == NULL || writerStop || dirtyFrames.load() <= writerHighWater){
+        return;
+    }
+    bufStats.add(BufCounter::PIN_WAITS, file);
+    ///the round in progress may have passed this page already, so wait for the one after it
+    const std::uint64_t target = writerRounds + 2;
+    writerKicked = true;
+    writerWake.notify_one();
+    writerRoundDone.wait(writerGuard, [this, target]() {
+        return writerThread == NULL || writerStop || writerRounds >= target ||
+               dirtyFrames.load() <= writerHighWater;
+    });
+}
+/**
+ *  Queue reads of the pages that are not already in the buffer pool and return without waiting.
+ *  The prefetch thread is started the first time it is needed.
+ * Input: file pointer, array of page numbers, length of the array
+ * Output: N/A
+ */
+void BufMgr::prefetch(File* file, const PageId* pages, const std::size_t n)
+{
+    std::lock_guard<std::mutex> prefetchGuard(prefetchLatch);
+    if(prefetchThread == NULL){
+        prefetchStop = false;
+        prefetchThread = new std::thread(&BufMgr::prefetchLoop, this);
+    }
+    for(std::size_t i = 0; i < n; i++){
+        prefetchQueue.push_back(std::make_pair(file, pages[i]));
+    }
+    prefetchWake.notify_one();
+}
+
+///first line of every manifest, with the format version
+static const char* const MANIFEST_HEADER = "badgerdb buffer manifest 1";
+
+/**
+ *  Write the resident pages, hottest first, to a manifest: the header, the number of files and
+ *  one file name per line, then the number of pages and one "file index, page number" per line
+ * Input: path of the manifest
+ * Output: number of pages listed
+ */
+std::size_t BufMgr::dumpResidentPages(const std::string& manifestName)
+{
+    ///resize() changes the pool size and the policy's together under victimLatch, so no candidate
+    ///can lie beyond the size read here
+    std::uint32_t bufs;
+    std::vector<FrameId> coldest;
+    {
+        std::lock_guard<std::mutex> victimGuard(victimLatch);
+        bufs = numBufs.load();
+        policy->evictionCandidates(coldest, bufs);
+    }
+
+    ///frames the policy did not offer are pinned or empty, and pinned ones are the hottest of all
+    std::vector<bool> offered(bufs, false);
+    for(std::size_t i = 0; i < coldest.size(); i++){
+        offered[coldest[i]] = true;
+    }
+    std::vector<FrameId> order;
+    order.reserve(bufs);
+    for(FrameId i = 0; i < bufs; i++){
+        if(!offered[i]){
+            order.push_back(i);
+        }
+    }
+    order.insert(order.end(), coldest.rbegin(), coldest.rend());
+
+    std::vector<std::string> names;
+    std::map<FileId, std::size_t> fileIndex;
+    std::vector<std::pair<std::size_t, PageId> > pages;
+    for(std::size_t i = 0; i < order.size(); i++){
+        BufDesc& desc = bufDescTable[order[i]];
+        std::lock_guard<std::mutex> descGuard(desc.latch);
+        if(!desc.valid()){
+            continue;
+        }
+        std::map<FileId, std::size_t>::iterator it = fileIndex.find(desc.fileId);
+        if(it == fileIndex.end()){
+            it = fileIndex.insert(std::make_pair(desc.fileId, names.size())).first;
+            names.push_back(residentFileName(desc.fileId));
+        }
+        pages.push_back(std::make_pair(it->second, desc.pageNo));
+    }
+
+    ///write beside the old manifest and swap it in, so a crash leaves one or the other whole
+    const std::string tmpName = manifestName + ".tmp";
+    {
+        std::ofstream out(tmpName.c_str(), std::ios::out | std::ios::trunc);
+        out << MANIFEST_HEADER << "\n" << names.size() << "\n";
+        for(std::size_t i = 0; i < names.size(); i++){
+            out << names[i] << "\n";
+        }
+        out << pages.size() << "\n";
+        for(std::size_t i = 0; i < pages.size(); i++){
+            out << pages[i].first << " " << pages[i].second << "\n";
+        }
+        out.flush();
+        if(!out){
+            throw InvalidManifestException(manifestName, "could not be written");
+        }
+    }
+    if(std::rename(tmpName.c_str(), manifestName.c_str()) != 0){
+        std::remove(tmpName.c_str());
+        throw InvalidManifestException(manifestName, "could not be written");
+    }
+    return pages.size();
+}
+
+/**
+ *  Queue the hottest pages of a manifest that fit in the pool for the prefetch thread, sorted by
+ *  file and page so that each file is read in one forward sweep
+ * Input: path of the manifest, files that may be loaded
+ * Output: number of pages queued
+ */
+std::size_t BufMgr::loadResidentPages(const std::string& manifestName, const std::vector<File*>& files)
+{
+    std::ifstream in(manifestName.c_str());
+    if(!in){
+        throw InvalidManifestException(manifestName, "could not be opened");
+    }
+    std::string header;
+    std::size_t numFiles = 0;
+    if(!std::getline(in, header) || header != MANIFEST_HEADER || !(in >> numFiles)){
+        throw InvalidManifestException(manifestName, "is not a buffer pool manifest");
+    }
+    in.ignore(1);
+
+    ///files of the manifest we were not given are skipped
+    std::vector<File*> byIndex(numFiles, NULL);
+    for(std::size_t i = 0; i < numFiles; i++){
+        std::string name;
+        if(!std::getline(in, name)){
+            throw InvalidManifestException(manifestName, "is truncated");
+        }
+        for(std::size_t j = 0; j < files.size(); j++){
+            if(files[j]->filename() == name){
+                byIndex[i] = files[j];
+            }
+        }
+    }
+
+    std::size_t numPages = 0;
+    if(!(in >> numPages)){
+        throw InvalidManifestException(manifestName, "is truncated");
+    }
+    const std::size_t room = numBufs.load();
+    std::vector<std::pair<File*, PageId> > wanted;
+    for(std::size_t i = 0; i < numPages && wanted.size() < room; i++){
+        std::size_t index;
+        PageId pageNo;
+        if(!(in >> index >> pageNo) || index >= numFiles){
+            throw InvalidManifestException(manifestName, "is truncated");
+        }
+        if(byIndex[index] != NULL){
+            wanted.push_back(std::make_pair(byIndex[index], pageNo));
+        }
+    }
+
+    std::sort(wanted.begin(), wanted.end(), [](const std::pair<File*, PageId>& a, const std::pair<File*, PageId>& b) {
+        if(a.first != b.first)
+            return std::less<File*>()(a.first, b.first);
+        return a.second < b.second;
+    });
+    std::vector<PageId> run;
+    for(std::size_t i = 0; i < wanted.size(); i++){
+        run.push_back(wanted[i].second);
+        if(i + 1 == wanted.size() || wanted[i + 1].first != wanted[i].first){
+            prefetch(wanted[i].first, run.data(), run.size());
+            run.clear();
+        }
+    }
+    return wanted.size();
+}
+
+///drop queued prefetches of file and wait out the one being read, if it is of file
+void BufMgr::cancelPrefetches(const File* file)
+{
+    std::unique_lock<std::mutex> prefetchGuard(prefetchLatch);
+    for(std::deque<std::pair<File*, PageId> >::iterator it = prefetchQueue.begin(); it != prefetchQueue.end(); ){
+        if(it->first->id() == file->id()){
+            it = prefetchQueue.erase(it);
+        }else{
+            ++it;
+        }
+    }
+    prefetchIdle.wait(prefetchGuard, [this, file]() {
+        return prefetchInFlight == NULL || prefetchInFlight->id() != file->id();
+    });
+}
+
+///ask the prefetch thread to exit, dropping whatever is still queued, and wait for it
+void BufMgr::stopPrefetcher()
+{
+    std::thread* running;
+    {
+        std::lock_guard<std::mutex> prefetchGuard(prefetchLatch);
+        running = prefetchThread;
+        prefetchStop = true;
+        prefetchQueue.clear();
+    }
+    if(running == NULL){
+        return;
+    }
+    prefetchWake.notify_all();
+    running->join();
+    delete running;
+
+    std::lock_guard<std::mutex> prefetchGuard(prefetchLatch);
+    prefetchThread = NULL;
+}
+
+///body of the prefetch thread: load queued pages one at a time until stopped
+void BufMgr::prefetchLoop()
+{
+    std::unique_lock<std::mutex> prefetchGuard(prefetchLatch);
+    for(;;){
+        prefetchWake.wait(prefetchGuard, [this]() { return prefetchStop || !prefetchQueue.empty(); });
+        if(prefetchStop){
+            return;
+        }
+        const std::pair<File*, PageId> next = prefetchQueue.front();
+        prefetchQueue.pop_front();
+        prefetchInFlight = next.first;
+        prefetchGuard.unlock();
+
+        prefetchPage(next.first, next.second);
+
+        prefetchGuard.lock();
+        prefetchInFlight = NULL;
+        prefetchIdle.notify_all();
+    }
+}
+
+/**
+ *  Load one page into an unpinned frame. The frame is hashed before the read starts, marked ioBusy
+ *  and not yet valid, so a readPage() of the page pins it and waits instead of reading it again.
+ *  A prefetch that cannot get a frame or whose read fails is dropped without a word; a later
+ *  readPage() of the page will report the error.
+ * Input: file pointer, pageNo
+ * Output: N/A
+ */
+void BufMgr::prefetchPage(File* file, const PageId pageNo)
+{
+    std::mutex& partition = hashTable->partitionLatch(file, pageNo);
+    FrameId frameNo;
+    {
+        std::lock_guard<std::mutex> partitionGuard(partition);
+        if(hashTable->tryLookup(file, pageNo, frameNo)){
+            return;
+        }
+    }
+
+    if(tryAllocBuf(frameNo, file) != Status::OK){
+        return;
+    }
+
+    BufDesc& desc = bufDescTable[frameNo];
+    {
+        std::lock_guard<std::mutex> partitionGuard(partition);
+        FrameId loadedFrame;
+        if(hashTable->tryLookup(file, pageNo, loadedFrame)){
+            releaseBuf(frameNo);
+            return;
+        }
+        ///keep the reservation's pin until the page is in, so the frame cannot be evicted half read
+        std::lock_guard<std::mutex> descGuard(desc.latch);
+        desc.assign(file->id(), pageNo);
+        desc.setFlag(BufDesc::IO_BUSY);
+        linkFrame(frameNo, file);
+        hashTable->insert(file, pageNo, frameNo);
+    }
+
+    bool loaded;
+    try {
+        loaded = loadFrame(file, pageNo, frameNo) == Status::OK;
+    }
+    catch (...) {
+        loaded = false;
+    }
+
+    {
+        std::lock_guard<std::mutex> descGuard(desc.latch);
+        desc.clearFlag(BufDesc::IO_BUSY);
+        if(loaded){
+            desc.setFlag(BufDesc::VALID);
+            policy->loaded(frameNo, file, pageNo);
+            unpinFrame(frameNo);
+        }
+    }
+    ioDone.notify_all();
+    if(loaded){
+        return;
+    }
+
+    ///waiters have been told; take the page back out and let the last of them clear the frame
+    std::lock_guard<std::mutex> partitionGuard(partition);
+    std::lock_guard<std::mutex> descGuard(desc.latch);
+    if(desc.holds(file, pageNo) && !desc.valid()){
+        hashTable->remove(file, pageNo);
+        policy->freed(frameNo);
+        unpinFrame(frameNo);
+        if(desc.pinCnt() == 0){
+            unlinkFrame(frameNo);
+            desc.Clear();
+        }
+    }
+}
 
 void BufMgr::printSelf(void) 
 {
   BufDesc* tmpbuf;
 	int validFrames = 0;
   
-  for (std::uint32_t i = 0; i < numBufs; i++)
+  for (std::uint32_t i = 0; i < numBufs.load(); i++)
 	{
   	tmpbuf = &(bufDescTable[i]);
 		std::cout << "FrameNo:" << i << " ";
 		tmpbuf->Print();
 
-  	if (tmpbuf->valid == true)
+  	if (tmpbuf->valid())
     	validFrames++;
   }
 
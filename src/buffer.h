@@ -8,8 +8,27 @@
 #pragma once
 
 #include "file.h"
+#include "async.h"
 #include "bufHashTbl.h"
+#include "buffer_arena.h"
+#include "buffer_ring.h"
+#include "buffer_stats.h"
+#include "compressed_tier.h"
+#include "page_guard.h"
+#include "secondary_cache.h"
+#include "replacement/replacement_policy.h"
 #include <iostream>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <string>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace badgerdb {
 
@@ -18,18 +37,52 @@ namespace badgerdb {
 */
 class BufMgr;
 
+/**
+* @brief How hard the buffer pool tries to keep a page resident once it is unpinned
+*/
+enum class PagePriority {
+  NORMAL,   /**< Evicted whenever the replacement policy picks it */
+  HIGH,     /**< Passed over the first few times the policy picks it, as if referenced again */
+  STICKY    /**< Never picked by the policy until the priority is lowered; flushFile() still drops it */
+};
+
+/**
+* Size of a cache line; each BufDesc starts on its own so that pinning one frame never slows
+* down threads pinning its neighbours
+*/
+static const std::size_t CACHE_LINE_SIZE = 64;
+
 /**
 * @brief Class for maintaining information about buffer pool frames
+*
+* The pin count and the dirty, valid and ioBusy flags share one atomic state word, so a pin, an
+* unpin or dirtying a page is a single atomic operation. The pin count only moves between zero
+* and non-zero under latch, which is when the replacement policy has to be told; above zero it
+* moves without the latch. All other fields except frameNo are guarded by latch. A frame whose pin
+* count is non-zero while it is not valid has been reserved by allocBuf() and is being filled by
+* its new owner.
 */
-class BufDesc {
+class alignas(CACHE_LINE_SIZE) BufDesc {
 
 	friend class BufMgr;
 
  private:
 	/**
-   * Pointer to file to which corresponding frame is assigned
+   * Latch guarding the fields of this descriptor
 	 */
-  File* file;
+  std::mutex latch;
+
+	/**
+   * Pin count in the low 32 bits, then the DIRTY, VALID and IO_BUSY flags
+	 */
+  std::atomic<std::uint64_t> state;
+
+	/**
+   * ID of file to which corresponding frame is assigned, or File::INVALID_ID if none; any handle
+   * on the same file matches it. No handle is kept, since the one the page was loaded through
+   * may be destroyed while the page stays; I/O goes through a handle resolved at the time.
+	 */
+  FileId fileId;
 
 	/**
    * Page within file to which corresponding frame is assigned
@@ -41,37 +94,188 @@ class BufDesc {
 	 */
   FrameId	frameNo;
 
+	/**
+   * Priority of the page, NORMAL for every page just loaded. The replacement policy counts a
+   * STICKY frame as pinned whatever its pin count, so pinned() and unpinned() are only called
+   * when both change.
+	 */
+  PagePriority priority;
+
+	/**
+   * Times a HIGH page may yet be passed over when the policy picks it
+	 */
+  std::uint8_t chances;
+
+	/**
+   * Next frame holding a page of the same file, INVALID_FRAME at the end of the list. Guarded by
+   * BufMgr's fileIndexLatch rather than by latch.
+	 */
+  FrameId fileNext;
+
+	/**
+   * Previous frame holding a page of the same file, INVALID_FRAME at the head of the list. Guarded
+   * by BufMgr's fileIndexLatch rather than by latch.
+	 */
+  FrameId filePrev;
+
+	/**
+   * Bumped on every change optimistic readers must notice, and odd while the frame is pinned,
+   * since whoever holds a pin may be changing the page. Written under latch, read without it.
+	 */
+  std::atomic<std::uint64_t> version;
+
+	/**
+   * Marks the ends of the per-file frame lists
+	 */
+  static const FrameId INVALID_FRAME = ~0u;
+
+	/**
+   * Times a HIGH page is passed over after its priority is set
+	 */
+  static const std::uint8_t HIGH_CHANCES = 3;
+
+	/**
+   * Bits of state holding the pin count
+	 */
+  static const std::uint64_t PIN_MASK = 0xffffffffull;
+
+	/**
+   * Set in state if page is dirty
+	 */
+  static const std::uint64_t DIRTY = 1ull << 32;
+
+	/**
+   * Set in state if page is valid
+	 */
+  static const std::uint64_t VALID = 1ull << 33;
+
+	/**
+   * Set in state while I/O on the frame is in flight. Either the background writer is writing the
+   * page out, or, while VALID is still clear, the prefetcher is reading it in. Whoever does the I/O
+   * holds a pin for the duration, so the frame is not evicted, but flushFile() and disposePage()
+   * wait for it, and so does readPage() for a page that is being read.
+	 */
+  static const std::uint64_t IO_BUSY = 1ull << 34;
+
 	/**
    * Number of times this page has been pinned
 	 */
-  int pinCnt;
+  std::uint32_t pinCnt() const
+	{
+    return static_cast<std::uint32_t>(state.load(std::memory_order_acquire) & PIN_MASK);
+  }
 
 	/**
    * True if page is dirty;  false otherwise
 	 */
-  bool dirty;
+  bool dirty() const
+	{
+    return (state.load(std::memory_order_acquire) & DIRTY) != 0;
+  }
 
 	/**
    * True if page is valid
 	 */
-  bool valid;
+  bool valid() const
+	{
+    return (state.load(std::memory_order_acquire) & VALID) != 0;
+  }
+
+	/**
+   * True while I/O on the frame is in flight; see IO_BUSY
+	 */
+  bool ioBusy() const
+	{
+    return (state.load(std::memory_order_acquire) & IO_BUSY) != 0;
+  }
+
+	/**
+	 * Sets a flag of state.
+	 *
+	 * @param flag	DIRTY, VALID or IO_BUSY
+	 * @return	true if the flag was clear before
+	 */
+  bool setFlag(const std::uint64_t flag)
+	{
+    return (state.fetch_or(flag, std::memory_order_acq_rel) & flag) == 0;
+  }
+
+	/**
+	 * Clears a flag of state.
+	 *
+	 * @param flag	DIRTY, VALID or IO_BUSY
+	 * @return	true if the flag was set before
+	 */
+  bool clearFlag(const std::uint64_t flag)
+	{
+    return (state.fetch_and(~flag, std::memory_order_acq_rel) & flag) != 0;
+  }
+
+	/**
+	 * Adds a pin to a frame someone else already has pinned, without the latch. The caller must
+	 * hold the latch of the frame's hash table partition, or latch, so the frame keeps its page.
+	 *
+	 * @return	false, with nothing changed, if the frame is not pinned
+	 */
+  bool tryPin()
+	{
+    std::uint64_t current = state.load(std::memory_order_relaxed);
+    do {
+      if ((current & PIN_MASK) == 0) {
+        return false;
+      }
+    } while (!state.compare_exchange_weak(current, current + 1, std::memory_order_acq_rel,
+                                          std::memory_order_relaxed));
+    return true;
+  }
+
+	/**
+	 * Drops a pin that is not the frame's last, without the latch. Marking a page dirty is left
+	 * to the latched path, unless it is dirty already, so that dirtyFrames moves with the flag.
+	 *
+	 * @param setDirty	Whether the page is to be marked dirty
+	 * @return	false, with nothing changed, if the frame has fewer than two pins or the page
+	 * 			would become dirty
+	 */
+  bool tryUnpin(const bool setDirty)
+	{
+    std::uint64_t current = state.load(std::memory_order_relaxed);
+    do {
+      if ((current & PIN_MASK) < 2 || (setDirty && (current & DIRTY) == 0)) {
+        return false;
+      }
+    } while (!state.compare_exchange_weak(current, current - 1, std::memory_order_acq_rel,
+                                          std::memory_order_relaxed));
+    return true;
+  }
 
 	/**
-   * Has this buffer frame been reference recently
+	 * Moves version on to the next value that is odd if the frame is pinned and even if not.
+	 * A pin is followed by a fence, so no change made under it can be seen before the odd value.
 	 */
-  bool refbit;
+  void bumpVersion()
+	{
+    const std::uint64_t current = version.load(std::memory_order_relaxed);
+    const bool pinned = pinCnt() > 0;
+    const std::uint64_t next = current + (((current & 1) != 0) == pinned ? 2 : 1);
+    if (pinned) {
+      version.store(next, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+    } else {
+      version.store(next, std::memory_order_release);
+    }
+  }
 
 	/**
    * Initialize buffer frame for a new user
 	 */
   void Clear()
 	{
-    pinCnt = 0;
-		file = NULL;
-		pageNo = Page::INVALID_NUMBER;
-    dirty = false;
-    refbit = false;
-		valid = false;
+    state.store(0, std::memory_order_release);
+    priority = PagePriority::NORMAL;
+    chances = 0;
+    assign(File::INVALID_ID, Page::INVALID_NUMBER);
+    bumpVersion();
   };
 
 	/**
@@ -83,200 +287,1381 @@ class BufDesc {
 	 */
   void Set(File* filePtr, PageId pageNum)
 	{ 
-		file = filePtr;
-    pageNo = pageNum;
-    pinCnt = 1;
-    dirty = false;
-    valid = true;
-    refbit = true;
+    assign(filePtr->id(), pageNum);
+    state.store(VALID | 1, std::memory_order_release);
+    priority = PagePriority::NORMAL;
+    chances = 0;
+    bumpVersion();
+  }
+
+	/**
+	 * Returns true if the frame is assigned to the given page, through any handle on its file.
+	 *
+	 * @param filePtr	File object
+	 * @param pageNum	Page number in the file
+	 */
+  bool holds(const File* filePtr, const PageId pageNum) const
+	{
+		return holds(filePtr->id(), pageNum);
+  }
+
+	/**
+	 * Assigns the frame to a page. Each field is stored atomically, as heldVersion() reads them
+	 * with no latch held; the frame is pinned, or the page is being cleared, so the version moves
+	 * on before any reader could trust the new values.
+	 *
+	 * @param id		ID of the file
+	 * @param pageNum	Page number in the file
+	 */
+  void assign(const FileId id, const PageId pageNum)
+	{
+    std::atomic_ref<FileId>(fileId).store(id, std::memory_order_relaxed);
+    std::atomic_ref<PageId>(pageNo).store(pageNum, std::memory_order_relaxed);
+  }
+
+	/**
+	 * Checks without the latch that the frame holds the given page unpinned, reading the page
+	 * between two reads of the version and trying again if they differ.
+	 *
+	 * @param id		ID of the file
+	 * @param pageNum	Page number in the file
+	 * @param seen		Set to the version the frame had while it held the page
+	 * @return  True if the frame held the page and was not pinned
+	 */
+  bool heldVersion(const FileId id, const PageId pageNum, std::uint64_t& seen)
+	{
+    for (;;) {
+      seen = version.load(std::memory_order_acquire);
+      if ((seen & 1) != 0) {
+        return false;
+      }
+      const bool matches = std::atomic_ref<FileId>(fileId).load(std::memory_order_relaxed) == id &&
+                           std::atomic_ref<PageId>(pageNo).load(std::memory_order_relaxed) == pageNum;
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (version.load(std::memory_order_relaxed) == seen) {
+        return matches && id != File::INVALID_ID;
+      }
+    }
+  }
+
+	/**
+	 * Returns true if the frame is assigned to the given page of the file with the given ID.
+	 *
+	 * @param id		ID of the file
+	 * @param pageNum	Page number in the file
+	 */
+  bool holds(const FileId id, const PageId pageNum) const
+	{
+		return id != File::INVALID_ID && fileId == id && pageNo == pageNum;
   }
 
   void Print()
 	{
-		if(file != NULL)
+		if(fileId != File::INVALID_ID)
 		{
-			std::cout << "file:" << file->filename() << " ";
+			std::cout << "file:" << fileId << " ";
 			std::cout << "pageNo:" << pageNo << " ";
 		}
 		else
 			std::cout << "file:NULL ";
 
-		std::cout << "valid:" << valid << " ";
-		std::cout << "pinCnt:" << pinCnt << " ";
-		std::cout << "dirty:" << dirty << " ";
-		std::cout << "refbit:" << refbit << "\n";
+		std::cout << "valid:" << valid() << " ";
+		std::cout << "pinCnt:" << pinCnt() << " ";
+		std::cout << "dirty:" << dirty() << "\n";
   }
 
 	/**
    * Constructor of BufDesc class 
 	 */
   BufDesc()
+    : state(0),
+      version(0)
 	{
+    fileNext = filePrev = INVALID_FRAME;
   	Clear();
   }
 };
 
+/**
+* @brief Identifies one page of one file, for the batched calls of BufMgr
+*/
+struct PageKey
+{
+	/**
+   * File the page belongs to
+	 */
+  File* file;
+
+	/**
+   * Page number in the file
+	 */
+  PageId pageNo;
+};
+
 
 /**
-* @brief Class to maintain statistics of buffer usage 
+* @brief A page found by BufMgr::readPageOptimistic(), readable without a pin for as long as
+*        BufMgr::validate() says it is unchanged
 */
-struct BufStats
+struct OptimisticPage
 {
 	/**
-   * Total number of accesses to buffer pool
+   * The page; its bytes may be changing underneath whoever reads them
+	 */
+  const Page* page;
+
+	/**
+   * Frame holding the page
 	 */
-  int accesses;
+  FrameId frame;
 
 	/**
-   * Number of pages read from disk (including allocs)
+   * Version of the frame when the page was found
 	 */
-  int diskreads;
+  std::uint64_t version;
+};
+
+
+/**
+* @brief Reference to a page, such as a child of an index node or the next page of a chain, that
+*        BufMgr swizzles to the frame holding the page so that following it skips the hash table
+*
+* A reference starts out unswizzled and is swizzled by the first BufMgr::readPage() through it.
+* Eviction does not reach every reference to a page, so each one is unswizzled when it is next
+* followed and its frame no longer holds the page. Pages on disk only ever hold page numbers;
+* references live in the caller's memory, alongside whatever caches it keeps of a page, and may
+* be followed by many threads at once.
+*/
+class PageRef
+{
+	friend class BufMgr;
+
+ public:
+	/**
+	 * Constructs an unswizzled reference.
+	 *
+	 * @param fileIn		File of the page
+	 * @param pageNoIn	Page number in the file
+	 */
+  PageRef(File* fileIn, const PageId pageNoIn)
+    : file(fileIn), pageNo(pageNoIn), frame(UNSWIZZLED) {}
 
 	/**
-   * Number of pages written back to disk
+	 * Constructs a reference to the same page, swizzled to the same frame.
 	 */
-  int diskwrites;
+  PageRef(const PageRef& other)
+    : file(other.file), pageNo(other.pageNo), frame(other.frame.load(std::memory_order_relaxed)) {}
 
 	/**
-   * Clear all values 
+   * True if the reference points at the frame that last held the page
 	 */
-  void clear()
+  bool swizzled() const
   {
-		accesses = diskreads = diskwrites = 0;
+		return frame.load(std::memory_order_relaxed) != UNSWIZZLED;
   }
-      
+
 	/**
-   * Constructor of BufStats class 
+   * File the page belongs to
 	 */
-  BufStats()
-  {
-		clear();
-  }
+  File* const file;
+
+	/**
+   * Page number in the file
+	 */
+  const PageId pageNo;
+
+ private:
+	/**
+   * Value of frame when unswizzled
+	 */
+  static const FrameId UNSWIZZLED = ~0u;
+
+	/**
+   * Frame that last held the page, checked every time the reference is followed
+	 */
+  std::atomic<FrameId> frame;
 };
 
 
 /**
 * @brief The central class which manages the buffer pool including frame allocation and deallocation to pages in the file 
+*
+* Which page gets evicted is up to the ReplacementPolicy the manager is built with.
+*
+* BufMgr is safe to use from many threads at once. Lock order is: victimLatch, then a hash table
+* partition latch, then a BufDesc latch, then the policy's own latch, fileIndexLatch, ioLatch or the
+* compressed tier's latch. writerLatch and
+* prefetchLatch come last and nothing else is taken while either is held. A pin of a page that is
+* already pinned, and an unpin that leaves a pin behind, take only the partition latch; see BufDesc.
+*
+* An optional background writer writes dirty pages out ahead of the replacement policy, so that
+* allocBuf() usually finds a clean victim and a read miss does not wait for a write.
 */
 class BufMgr 
 {
+	friend class PageGuard;
+
  private:
 	/**
-   * Current position of clockhand in our buffer pool
+   * Chooses victim frames and is told about every pin, unpin, load and eviction
 	 */
-  FrameId clockHand;
+  ReplacementPolicy* policy;
 
 	/**
-   * Number of frames in the buffer pool
+   * Serializes victim selection in allocBuf(). Pins and unpins never take it.
 	 */
-  std::uint32_t numBufs;
-	
+  std::mutex victimLatch;
+
 	/**
-   * Hash table mapping (File, page) to frame
+   * Victims claimed per replacement policy search, when the reservoir is empty. Guarded by
+   * victimLatch.
 	 */
-  BufHashTbl *hashTable;
+  std::uint32_t victimBatch;
 
 	/**
-   * Array of BufDesc objects to hold information corresponding to every frame allocation from 'bufPool' (the buffer pool)
+   * Frames claimed by an earlier search beyond the one it needed, already written back, unhashed,
+   * empty and pinned, for the next misses to take. Guarded by victimLatch.
 	 */
-  BufDesc *bufDescTable;
+  std::vector<FrameId> reservoir;
 
 	/**
-   * Maintains Buffer pool usage statistics 
+   * Serializes calls into File, whose stream is not threadsafe
 	 */
-  BufStats bufStats;
+  std::mutex ioLatch;
 
 	/**
-   * Advance clock to next frame in the buffer pool
+   * Number of frames in the buffer pool. Changed by resize() under victimLatch.
 	 */
-  void advanceClock();
+  std::atomic<std::uint32_t> numBufs;
 
 	/**
-	 * Allocate a free frame.  
-	 *
-	 * @param frame   	Frame reference, frame ID of allocated frame returned via this variable
-	 * @throws BufferExceededException If no such buffer is found which can be allocated
+   * Most frames the pool can be resized to. Descriptors, views and arena are sized for this many.
 	 */
-  void allocBuf(FrameId & frame);
+  const std::uint32_t maxBufs;
 
- public:
 	/**
-   * Actual buffer pool from which frames are allocated
+   * Serializes calls to resize()
 	 */
-  Page* bufPool;
+  std::mutex resizeLatch;
 
 	/**
-   * Constructor of BufMgr class
+   * Manifest the destructor writes with dumpResidentPages(); empty for none
 	 */
-  BufMgr(std::uint32_t bufs);
-	
+  std::string shutdownManifest;
+
 	/**
-   * Destructor of BufMgr class
+   * Compressed copies of evicted pages, consulted on a miss before the file; NULL if not enabled
 	 */
-  ~BufMgr();
+  CompressedTier* compressedTier;
 
 	/**
-	 * Reads the given page from the file into a frame and returns the pointer to page.
-	 * If the requested page is already present in the buffer pool pointer to that frame is returned
-	 * otherwise a new frame is allocated from the buffer pool for reading the page.
-	 *
-	 * @param file   	File object
-	 * @param PageNo  Page number in the file to be read
-	 * @param page  	Reference to page pointer. Used to fetch the Page object in which requested page from file is read in.
+   * Evicted pages kept in a cache file on fast storage, consulted on a miss after the compressed
+   * tier; NULL if not enabled
 	 */
-  void readPage(File* file, const PageId PageNo, Page*& page);
+  SecondaryCache* secondaryCache;
 
 	/**
-	 * Unpin a page from memory since it is no longer required for it to remain in memory.
+   * Evicted pages being written to the secondary cache, with the number of writes in flight for
+   * each. Guarded by admitLatch.
+	 */
+  std::map<std::pair<FileId, PageId>, std::uint32_t> admitting;
+
+	/**
+   * Guards admitting. Taken after every other latch.
+	 */
+  std::mutex admitLatch;
+
+	/**
+   * Signalled whenever a page leaves admitting
+	 */
+  std::condition_variable admitDone;
+
+	/**
+   * Copy of an evicted page on its way to the secondary cache
+	 */
+  struct Admission
+  {
+    std::string fileName;
+    FileId fileId;
+    PageId pageNo;
+    std::vector<char> bytes;
+  };
+
+	/**
+	 * Write evicted pages to the secondary cache. Called with no latch held, after claimFrame() has
+	 * entered each page in admitting and dropped it from the pool.
 	 *
-	 * @param file   	File object
-	 * @param PageNo  Page number
-	 * @param dirty		True if the page to be unpinned needs to be marked dirty	
-   * @throws  PageNotPinnedException If the page is not already pinned
+	 * @param admitted	Copies claimFrame() took before the pages left the pool
 	 */
-  void unPinPage(File* file, const PageId PageNo, const bool dirty);
+  void admitToSecondaryCache(const std::vector<Admission>& admitted);
 
 	/**
-	 * Allocates a new, empty page in the file and returns the Page object.
-	 * The newly allocated page is also assigned a frame in the buffer pool.
+	 * Wait until no write of the page to the secondary cache is in flight, so that taking or
+	 * dropping its copy is not overtaken by the write.
 	 *
-	 * @param file   	File object
-	 * @param PageNo  Page number. The number assigned to the page in the file is returned via this reference.
-	 * @param page  	Reference to page pointer. The newly allocated in-memory Page object is returned via this reference.
+	 * @param file   	ID of the page's file
+	 * @param pageNo  Page number in the file; Page::INVALID_NUMBER for every page of the file
 	 */
-  void allocPage(File* file, PageId &PageNo, Page*& page); 
+  void awaitAdmission(const FileId file, const PageId pageNo);
 
 	/**
-	 * Writes out all dirty pages of the file to disk.
-	 * All the frames assigned to the file need to be unpinned from buffer pool before this function can be successfully called.
-	 * Otherwise Error returned.
+   * Loop the asynchronous calls run their blocking work through; NULL to run it in place
+	 */
+  EventLoop* eventLoop;
+
+	/**
+	 * Fill a frame reserved for a page with the page, from the compressed tier or the secondary
+	 * cache if either holds a copy and from the file otherwise.
 	 *
-	 * @param file   	File object
-   * @throws  PagePinnedException If any page of the file is pinned in the buffer pool 
-   * @throws BadBufferException If any frame allocated to the file is found to be invalid
+	 * @param file   	File of the page
+	 * @param pageNo  Page number in the file
+	 * @param frame   Reserved frame
+	 * @return  Status::OK, or Status::INVALID_PAGE if the file has no such page
 	 */
-  void flushFile(const File* file);
+  Status loadFrame(File* file, const PageId pageNo, const FrameId frame);
 
 	/**
-	 * Delete page from file and also from buffer pool if present.
-	 * Since the page is entirely deleted from file, its unnecessary to see if the page is dirty.
+	 * Fill a frame reserved for a page with the page from the compressed tier or the secondary
+	 * cache, counting the hit.
 	 *
-	 * @param file   	File object
-	 * @param PageNo  Page number
+	 * @param file   	File of the page
+	 * @param pageNo  Page number in the file
+	 * @param frame   Reserved frame
+	 * @return  False if neither holds a copy of the page
 	 */
-  void disposePage(File* file, const PageId PageNo);
+  bool takeFromTiers(File* file, const PageId pageNo, const FrameId frame);
+	
+	/**
+   * Contiguous memory holding the bytes of every frame
+	 */
+  BufferArena* arena;
 
 	/**
-   * Print member variable values. 
+   * Hash table mapping (File, page) to frame
 	 */
-  void  printSelf();
+  BufHashTbl *hashTable;
 
 	/**
-   * Get buffer pool usage statistics
+   * Array of BufDesc objects to hold information corresponding to every frame allocation from 'bufPool' (the buffer pool)
+	 */
+  BufDesc *bufDescTable;
+
+	/**
+   * Maintains Buffer pool usage statistics, in total and per file
+	 */
+  BufMetrics bufStats;
+
+	/**
+   * Head of a file's list of frames, the length of the list, and the file's name, by which a
+   * handle for I/O on its pages is opened
+	 */
+  struct FileFrames
+  {
+    FrameId head;
+    std::uint32_t count;
+    std::uint32_t group;
+    std::string name;
+
+    FileFrames() : head(BufDesc::INVALID_FRAME), count(0), group(NO_GROUP) {}
+  };
+
+	/**
+   * Group number of a file that is in no group
+	 */
+  static const std::uint32_t NO_GROUP = ~0u;
+
+	/**
+   * Frames a group of files has reserved, the most it may hold, how many it holds now, and the
+   * files in it
+	 */
+  struct FrameQuota
+  {
+    std::uint32_t minFrames;
+    std::uint32_t maxFrames;
+    std::uint32_t frames;
+    std::vector<FileId> files;
+
+    FrameQuota() : minFrames(0), maxFrames(~0u), frames(0) {}
+  };
+
+	/**
+   * Quota of every group, indexed by group number. Guarded by fileIndexLatch.
+	 */
+  std::vector<FrameQuota> quotas;
+
+	/**
+   * Group number of each group name. Guarded by fileIndexLatch.
+	 */
+  std::unordered_map<std::string, std::uint32_t> groupNumbers;
+
+	/**
+   * Group number of each file put in a group. Guarded by fileIndexLatch.
+	 */
+  std::unordered_map<FileId, std::uint32_t> fileGroups;
+
+	/**
+   * True while some group has a quota or a reservation, and while some group has a reservation,
+   * so that misses skip fileIndexLatch when none does. Written under fileIndexLatch.
+	 */
+  std::atomic<bool> anyQuota;
+  std::atomic<bool> anyReservation;
+
+	/**
+   * Frames holding pages of each file with any page in the pool, linked through the descriptors
+	 */
+  std::unordered_map<FileId, FileFrames> fileFrames;
+
+	/**
+   * Guards fileFrames, the quota fields above and the fileNext and filePrev fields of every descriptor
+	 */
+  std::mutex fileIndexLatch;
+
+	/**
+   * Number of the named group, which is made with no limits if it does not exist yet. Caller
+   * holds fileIndexLatch.
+	 */
+  std::uint32_t groupNumber(const std::string& group);
+
+	/**
+   * Group a miss on file must take a frame from: the file's own group if it is at its quota,
+   * otherwise any group over its quota, otherwise NO_GROUP.
+	 *
+	 * @param file   	File of the missing page; NULL for none
+	 * @param ownGroup	Group of file is returned via this variable
+	 */
+  std::uint32_t shrinkingGroup(const File* file, std::uint32_t& ownGroup);
+
+	/**
+   * Eviction candidates claimFromGroup() asks the policy for before walking the group's own frames
+	 */
+  static const std::size_t GROUP_CANDIDATES = 16;
+
+	/**
+   * Claim an unpinned frame of group: one of the policy's next few victims if any belongs to the
+   * group, otherwise the least recently loaded page of one of its files. HIGH pages are spared
+   * and STICKY ones skipped, as in the main victim search. Caller holds victimLatch.
+	 *
+	 * @param group   	Group to take the frame from
+	 * @param frame   	Claimed frame is returned via this variable
+	 * @param admitted	Pages evicted for the secondary cache are added to this variable
+	 * @return  False if every frame of the group is pinned
+	 */
+  bool claimFromGroup(const std::uint32_t group, FrameId& frame, std::vector<Admission>& admitted);
+
+	/**
+   * Group of the page in frame; NO_GROUP if the frame is empty or its file is in no group
+	 */
+  std::uint32_t frameGroup(const FrameId frame);
+
+	/**
+   * Caller holds victimLatch. True if candidate holds a page of a group other than ownGroup that
+   * has no more frames than it reserved, in which case it counts as referenced again.
+	 */
+  bool reservedVictim(const FrameId candidate, const std::uint32_t ownGroup);
+
+	/**
+   * Add a frame that has just been given a page of file to its file's list. Caller holds the
+   * frame's latch.
+	 */
+  void linkFrame(const FrameId frame, const File* file);
+
+	/**
+   * Take a frame off its file's list before it is cleared. Caller holds the frame's latch.
+	 */
+  void unlinkFrame(const FrameId frame);
+
+	/**
+   * Returns the name of a file with pages in the pool. Caller holds the latch of a frame holding
+   * one of them, so the file stays in fileFrames.
+	 */
+  std::string residentFileName(const FileId fileId);
+
+	/**
+   * Drop every page of file from the pool, writing dirty ones back first if writeBack is set
+	 *
+	 * @param file   	File object
+	 * @param writeBack	True to write dirty pages to disk, false to discard them
+	 */
+  void evictFile(const File* file, const bool writeBack);
+
+	/**
+	 * Write dirty pages of one file in page number order, each run of consecutive pages with one
+	 * write, then sync the file once. The caller keeps the frames from changing meanwhile.
+	 *
+	 * @param file   	File the pages belong to
+	 * @param pages   	(page number, frame) of each page; sorted in place
+	 * @param written	Number of pages written so far, also when an exception is thrown
+	 */
+  void writeRuns(File* file, std::vector<std::pair<PageId, FrameId> >& pages, std::size_t& written);
+
+	/**
+	 * Write back the dirty pages evictFile() gathered, which it left pinned and ioBusy, then drop
+	 * from the pool those nobody pinned or dirtied again in the meantime. Pages that could not be
+	 * written stay dirty and the error is rethrown.
+	 *
+	 * @param file   	File the pages belong to, as given to evictFile()
+	 * @param pending	(page number, frame) of each gathered page
+	 */
+  void writeBackPending(const File* file, std::vector<std::pair<PageId, FrameId> >& pending);
+
+	/**
+   * Number of frames holding a dirty page
+	 */
+  std::atomic<std::uint32_t> dirtyFrames;
+
+	/**
+   * Signalled whenever the background writer clears a frame's ioBusy flag
+	 */
+  std::condition_variable_any ioDone;
+
+	/**
+   * Background writer thread, NULL while it is not running
+	 */
+  std::thread* writerThread;
+
+	/**
+   * Guards the writer fields below
+	 */
+  std::mutex writerLatch;
+
+	/**
+   * Wakes the background writer before its interval is up
+	 */
+  std::condition_variable writerWake;
+
+	/**
+   * Signalled each time the background writer finishes a round
+	 */
+  std::condition_variable writerRoundDone;
+
+	/**
+   * Set to ask the background writer to exit
+	 */
+  bool writerStop;
+
+	/**
+   * Set when the background writer has been asked for another round straight away
+	 */
+  bool writerKicked;
+
+	/**
+   * Number of rounds the background writer has finished
+	 */
+  std::uint64_t writerRounds;
+
+	/**
+   * Number of frames at the head of the policy's eviction order the writer keeps clean
+	 */
+  std::uint32_t writerCleanTarget;
+
+	/**
+   * Dirty frame count above which the writer cleans every candidate and dirtiers are throttled.
+   * resize() rescales it, so it is read without writerLatch.
+	 */
+  std::atomic<std::uint32_t> writerHighWater;
+
+	/**
+   * Fraction of the pool writerHighWater stands for
+	 */
+  double writerDirtyFraction;
+
+	/**
+   * Time the writer sleeps between rounds when nobody wakes it
+	 */
+  std::chrono::milliseconds writerInterval;
+
+	/**
+   * Body of the background writer thread
+	 */
+  void backgroundWriterLoop();
+
+	/**
+   * One round of the background writer: write out dirty frames the policy would evict next.
+	 */
+  void cleanAhead();
+
+	/**
+   * Write the page in frame to disk if it is valid, dirty and unpinned.
+	 *
+	 * @param frame   	Frame to clean
+	 * @return  True if the page was written
+	 */
+  bool writeBehind(const FrameId frame);
+
+	/**
+   * Prefetch thread, NULL until the first call to prefetch()
+	 */
+  std::thread* prefetchThread;
+
+	/**
+   * Guards the prefetch fields below
+	 */
+  std::mutex prefetchLatch;
+
+	/**
+   * Wakes the prefetch thread when pages are queued or it is asked to stop
+	 */
+  std::condition_variable prefetchWake;
+
+	/**
+   * Signalled each time the prefetch thread finishes a page
+	 */
+  std::condition_variable prefetchIdle;
+
+	/**
+   * Pages waiting to be prefetched, oldest first
+	 */
+  std::deque<std::pair<File*, PageId> > prefetchQueue;
+
+	/**
+   * Set to ask the prefetch thread to exit
+	 */
+  bool prefetchStop;
+
+	/**
+   * File of the page the prefetch thread is loading, NULL while it is idle
+	 */
+  const File* prefetchInFlight;
+
+	/**
+   * Body of the prefetch thread
+	 */
+  void prefetchLoop();
+
+	/**
+   * Load a page into an unpinned frame unless it is already in the buffer pool
+	 *
+	 * @param file   	File object
+	 * @param pageNo  Page number in the file
+	 */
+  void prefetchPage(File* file, const PageId pageNo);
+
+	/**
+   * Drop queued prefetches of file and wait for one of its pages that is being read
+	 *
+	 * @param file   	File object
+	 */
+  void cancelPrefetches(const File* file);
+
+	/**
+   * Stop the prefetch thread, dropping whatever is still queued
+	 */
+  void stopPrefetcher();
+
+	/**
+   * Unpin the page a PageGuard holds. The frame is checked to still hold the page, in case it was
+   * disposed of while pinned, but the hash table is not consulted.
+	 *
+	 * @param frame   	Frame the page was pinned in
+	 * @param file   	File object
+	 * @param pageNo  Page number in the file
+	 * @param dirty		True if the page needs to be marked dirty
+	 */
+  void unPinFrame(const FrameId frame, const File* file, const PageId pageNo, const bool dirty);
+
+	/**
+   * Order in which readPages() and unPinPages() visit keys: grouped by hash table partition
+   * latch, then by file and page number, so equal keys are adjacent.
+	 *
+	 * @param keys   	Pages of the batch
+	 * @param n  			Number of entries in keys
+	 * @param latches	Filled with the partition latch of each key
+	 * @param order  	Filled with the indexes of keys in visiting order
+	 */
+  void batchOrder(const PageKey* keys, const std::size_t n, std::vector<std::mutex*>& latches,
+                  std::vector<std::size_t>& order);
+
+	/**
+   * Wait for a frame the caller has pinned to finish being prefetched
+	 *
+	 * @param frame   	Frame the page was found in
+	 * @param file   	File object
+	 * @param pageNo  Page number in the file
+	 * @return  True if the frame holds the page; false if the prefetch failed and the pin was dropped
+	 */
+  bool awaitLoad(const FrameId frame, File* file, const PageId pageNo);
+
+	/**
+   * Ask the background writer for a round now rather than after its interval
+	 */
+  void kickWriter();
+
+	/**
+   * Recompute writerHighWater from writerDirtyFraction for the current pool size
+	 */
+  void rescaleHighWater();
+
+	/**
+   * Block a thread that just dirtied a page while the dirty frame count is above the high-water
+   * mark, until the background writer has been through a full round. The wait is counted against file.
+	 */
+  void throttleDirtier(const File* file);
+
+	/**
+   * Increment the pin count of a frame whose latch the caller holds
+	 */
+  void pinFrame(const FrameId frame);
+
+	/**
+   * Pin a frame found in the hash table, whose partition latch the caller holds. The frame's own
+   * latch is only taken if nobody else has it pinned, to tell the policy.
+	 */
+  void pinResident(const FrameId frame);
+
+	/**
+   * Unpin a frame found in the hash table, whose partition latch the caller holds, as unPinPage()
+   * does. The frame's own latch is only taken for the last pin or to dirty a clean page.
+   *
+   * @param frame	Frame holding the page
+   * @param file	File of the page, for the exception
+   * @param pageNo	Page number, for the exception
+   * @param dirty	Whether the caller changed the page
+   * @throws PageNotPinnedException if the frame is not pinned
+	 */
+  void unpinResident(const FrameId frame, const File* file, const PageId pageNo, const bool dirty);
+
+	/**
+	 * Pin a page if it is in the pool and loaded, without waiting for a frame, a prefetch or I/O
+	 *
+	 * @param file   	File object
+	 * @param pageNo  Page number
+	 * @param page		Address of the pinned page returned via this variable
+	 * @return	false, with nothing pinned, if the page is not ready in the pool
+	 */
+  bool pinIfLoaded(File* file, const PageId pageNo, Page*& page);
+
+	/**
+   * Decrement the pin count of a frame whose latch the caller holds
+	 */
+  void unpinFrame(const FrameId frame);
+
+	/**
+	 * Reserve one frame offered by the policy or a ring, writing back and unhashing the page it
+	 * holds. Caller holds victimLatch, and writes what is added to admitted to the secondary cache
+	 * with admitToSecondaryCache() once it has released victimLatch, even if this throws.
+	 *
+	 * @param candidate   	Frame to reserve
+	 * @param admitted   	Copy of the evicted page is added to this variable if a secondary cache is enabled
+	 * @return  True if the frame is now reserved; false if it is in use and was left alone
+	 */
+  bool claimFrame(const FrameId candidate, std::vector<Admission>& admitted);
+
+	/**
+	 * Pass over a victim the policy offered if its page is HIGH and has chances left, using one.
+	 * Caller holds victimLatch.
+	 *
+	 * @param candidate   	Frame offered
+	 * @return  True if the frame was spared and should be treated as referenced again
+	 */
+  bool spareVictim(const FrameId candidate);
+
+	/**
+	 * Allocate a frame for a page read through ring, preferring the ring's own frames
+	 *
+	 * @param ring   	Ring of the scan
+	 * @param frame   	Frame ID of allocated frame returned via this variable
+	 * @param file   	File of the page the frame is for, which the sweep is counted against
+	 * @return  Status::BUFFER_EXCEEDED if the ring's frame is in use and no other frame can be allocated
+	 */
+  Status tryAllocRingBuf(BufferRing& ring, FrameId & frame, const File* file);
+
+	/**
+	 * Record which page the frame most recently added to ring holds
+	 */
+  void ringLoaded(BufferRing& ring, const FrameId frame, const File* file, const PageId pageNo);
+
+	/**
+	 * Body of tryReadPage() and both readPage() variants that return a pointer; ring is NULL for an
+	 * ordinary read
+	 */
+  Status tryFetchPage(File* file, const PageId pageNo, Page*& page, BufferRing* ring);
+
+	/**
+	 * Allocate a free frame.  The frame is returned reserved (pinCnt of 1, not valid) so that no
+	 * other thread can allocate it before the caller calls Set() or releaseBuf() on it.
+	 *
+	 * @param frame   	Frame reference, frame ID of allocated frame returned via this variable
+	 * @param file   	File of the page the frame is for, which the sweep is counted against
+	 * @throws BufferExceededException If no such buffer is found which can be allocated
+	 */
+  void allocBuf(FrameId & frame, const File* file);
+
+	/**
+	 * Allocate a free frame like allocBuf(), reporting a pool with every frame pinned as a status.
+	 *
+	 * @param frame   	Frame reference, frame ID of allocated frame returned via this variable
+	 * @param file   	File of the page the frame is for, which the sweep is counted against
+	 * @return  Status::OK, or Status::BUFFER_EXCEEDED if no frame can be allocated
+	 */
+  Status tryAllocBuf(FrameId & frame, const File* file);
+
+	/**
+	 * The search tryAllocBuf() makes for a frame. Caller holds victimLatch.
+	 *
+	 * @param frame   	Frame reference, frame ID of allocated frame returned via this variable
+	 * @param file   	File of the page the frame is for, which the sweep is counted against
+	 * @param admitted	Pages evicted for the secondary cache are added to this variable
+	 * @return  Status::OK, or Status::BUFFER_EXCEEDED if no frame can be allocated
+	 */
+  Status searchVictims(FrameId & frame, const File* file, std::vector<Admission>& admitted);
+
+	/**
+	 * Give back a frame reserved by allocBuf() that ended up not being used.
+	 *
+	 * @param frame   	Frame ID of the reserved frame
+	 */
+  void releaseBuf(const FrameId frame);
+
+ public:
+	/**
+   * Actual buffer pool from which frames are allocated. Each Page is a view over its frame's bytes
+   * in arena.
+	 */
+  Page* bufPool;
+
+	/**
+   * Constructor of BufMgr class
+	 *
+	 * @param bufs					Number of frames in the buffer pool
+	 * @param policyType		Page replacement policy to use
+	 * @param hugePages		Huge page backing to request for the frames
+	 * @param maxBufs				Most frames resize() may grow the pool to; bufs if smaller
+	 */
+  BufMgr(std::uint32_t bufs, ReplacementPolicyType policyType = ReplacementPolicyType::CLOCK,
+         HugePageMode hugePages = HugePageMode::NONE, std::uint32_t maxBufs = 0);
+	
+	/**
+   * Destructor of BufMgr class. Writes back every dirty page, pinned or not, the same way
+   * flushFile() does, and ignores errors doing so.
+	 */
+  ~BufMgr();
+
+	/**
+	 * Reads the given page from the file into a frame and returns the pointer to page.
+	 * If the requested page is already present in the buffer pool pointer to that frame is returned
+	 * otherwise a new frame is allocated from the buffer pool for reading the page.
+	 *
+	 * @param file   	File object
+	 * @param PageNo  Page number in the file to be read
+	 * @param page  	Reference to page pointer. Used to fetch the Page object in which requested page from file is read in.
+	 */
+  void readPage(File* file, const PageId PageNo, Page*& page);
+
+	/**
+	 * Reads the given page like readPage(file, PageNo, page), but a page that has to be read from
+	 * disk goes into one of the ring's frames rather than a victim chosen by the replacement policy.
+	 * Use it for large sequential reads that should not push other pages out of the pool.
+	 *
+	 * @param file   	File object
+	 * @param PageNo  Page number in the file to be read
+	 * @param page  	Reference to page pointer. Used to fetch the Page object in which requested page from file is read in.
+	 * @param ring  	Ring of the scan
+	 */
+  void readPage(File* file, const PageId PageNo, Page*& page, BufferRing& ring);
+
+	/**
+	 * Reads the given page like readPage(file, PageNo, page) and gives it a priority, as
+	 * setPriority() does.
+	 *
+	 * @param file   	File object
+	 * @param PageNo  Page number in the file to be read
+	 * @param page  	Reference to page pointer. Used to fetch the Page object in which requested page from file is read in.
+	 * @param priority	Priority of the page
+	 */
+  void readPage(File* file, const PageId PageNo, Page*& page, const PagePriority priority);
+
+	/**
+	 * Finds a resident page without pinning it, for lookups that only read. Nothing stops the page
+	 * being changed or evicted meanwhile, so whatever is read from it must be checked with
+	 * validate() before it is trusted, and must not be followed anywhere, such as to another page,
+	 * until it has been. Once found, the handle can be read and validated again and again with no
+	 * latch taken and nothing written, which is what makes hot pages cheap to share; only when
+	 * validate() fails does the page have to be found again.
+	 *
+	 * A pinned page may be being changed by whoever pinned it, so it is not found. Callers fall
+	 * back to readPage() when this returns false.
+	 *
+	 * Finding the page writes nothing shared either: the replacement policy and the statistics do
+	 * not hear of it, so a page that is only ever read this way looks unused and is evicted in its
+	 * turn. Only the hash table lookup takes a latch; readPageOptimistic(ref, handle) skips even
+	 * that while the reference's frame still holds the page.
+	 *
+	 * @param file   	File object
+	 * @param pageNo  Page number in the file
+	 * @param handle  Set to the page and its version if found
+	 * @return  False if the page is not resident or is pinned
+	 */
+  bool readPageOptimistic(File* file, const PageId pageNo, OptimisticPage& handle);
+
+	/**
+	 * Finds a page like readPageOptimistic(file, pageNo, handle), through a reference. While the
+	 * frame the reference is swizzled to still holds the page no latch is taken at all; otherwise
+	 * the page is looked up and the reference swizzled to its frame.
+	 *
+	 * @param ref   	Reference to the page
+	 * @param handle  Set to the page and its version if found
+	 * @return  False if the page is not resident or is pinned
+	 */
+  bool readPageOptimistic(PageRef& ref, OptimisticPage& handle);
+
+	/**
+	 * Tells whether everything read from a page since readPageOptimistic() found it is good, that
+	 * is, whether the frame has not since been pinned, evicted or given another page.
+	 *
+	 * @param handle  Page found by readPageOptimistic()
+	 * @return  True if the reads can be trusted
+	 */
+  bool validate(const OptimisticPage& handle) const
+  {
+		std::atomic_thread_fence(std::memory_order_acquire);
+		return bufDescTable[handle.frame].version.load(std::memory_order_relaxed) == handle.version;
+  }
+
+	/**
+	 * Reads the given page like readPage(file, PageNo, page), but returns a guard that unpins it.
+	 *
+	 * @param file   	File object
+	 * @param PageNo  Page number in the file to be read
+	 * @return  Guard holding the pinned page
+	 */
+  PageGuard readPage(File* file, const PageId PageNo);
+
+	/**
+	 * Reads a batch of pages, pinning each once per time it appears in keys. Pages already in the
+	 * buffer pool are found with one acquisition of each hash table partition latch, and the rest
+	 * are read from disk together, in file and page order. If any page cannot be read, nothing
+	 * stays pinned and the error is rethrown.
+	 *
+	 * @param keys   	Pages to read
+	 * @param n  			Number of entries in keys
+	 * @param pages  	Array of at least n entries; pages[i] is set to the page for keys[i]
+	 * @throws BufferExceededException If the pages that are not yet in the pool do not fit in it
+	 */
+  void readPages(const PageKey* keys, const std::size_t n, Page** pages);
+
+	/**
+	 * Unpin a page from memory since it is no longer required for it to remain in memory.
+	 *
+	 * @param file   	File object
+	 * @param PageNo  Page number
+	 * @param dirty		True if the page to be unpinned needs to be marked dirty	
+   * @throws  PageNotPinnedException If the page is not already pinned
+	 */
+  void unPinPage(File* file, const PageId PageNo, const bool dirty);
+
+	/**
+	 * Reads a page like readPage(file, PageNo, page) through a reference, going straight to the
+	 * frame it is swizzled to if that frame still holds the page. Otherwise the reference is
+	 * unswizzled, the page is read the usual way, and the reference is swizzled to its frame.
+	 *
+	 * @param ref   	Reference to the page
+	 * @param page  	Reference to page pointer. Used to fetch the Page object in which requested page from file is read in.
+	 */
+  void readPage(PageRef& ref, Page*& page);
+
+	/**
+	 * Reads a page like readPage(file, PageNo, page), reporting the ordinary ways that can fail as
+	 * a status rather than an exception. Errors such as failing to write back a dirty victim still
+	 * throw.
+	 *
+	 * @param file   	File object
+	 * @param PageNo  Page number in the file to be read
+	 * @param page  	Reference to page pointer, set only if the page was read
+	 * @return  Status::OK, Status::INVALID_PAGE if the file has no such page, or
+	 *          Status::BUFFER_EXCEEDED if every frame is pinned
+	 */
+  Status tryReadPage(File* file, const PageId PageNo, Page*& page);
+
+	/**
+	 * Unpins a page read through a reference like unPinPage(file, PageNo, dirty), going straight to
+	 * the frame it is swizzled to.
+	 *
+	 * @param ref   	Reference the page was read through
+	 * @param dirty		True if the page to be unpinned needs to be marked dirty
+   * @throws  PageNotPinnedException If the page is not already pinned
+	 */
+  void unPinPage(const PageRef& ref, const bool dirty);
+
+	/**
+	 * Unpins a batch of pages, once per time each appears in keys, taking each hash table partition
+	 * latch once. Pages are unpinned in partition order; if one of them is found not pinned, the
+	 * ones before it in that order stay unpinned.
+	 *
+	 * @param keys   	Pages to unpin
+	 * @param n  			Number of entries in keys
+	 * @param dirty		True if the pages need to be marked dirty
+   * @throws  PageNotPinnedException If a page is not pinned as many times as it appears
+	 */
+  void unPinPages(const PageKey* keys, const std::size_t n, const bool dirty);
+
+	/**
+	 * Allocates a new, empty page in the file and returns the Page object.
+	 * The newly allocated page is also assigned a frame in the buffer pool.
+	 *
+	 * @param file   	File object
+	 * @param PageNo  Page number. The number assigned to the page in the file is returned via this reference.
+	 * @param page  	Reference to page pointer. The newly allocated in-memory Page object is returned via this reference.
+	 */
+  void allocPage(File* file, PageId &PageNo, Page*& page); 
+
+	/**
+	 * Allocates a page like allocPage(file, PageNo, page), reporting a pool with every frame pinned
+	 * as a status rather than an exception. The frame is found first, so a full pool leaves the
+	 * file as it was.
+	 *
+	 * @param file   	File object
+	 * @param PageNo  Page number. The number assigned to the page in the file is returned via this reference.
+	 * @param page  	Reference to page pointer, set only if the page was allocated
+	 * @return  Status::OK, or Status::BUFFER_EXCEEDED if every frame is pinned
+	 */
+  Status tryAllocPage(File* file, PageId &PageNo, Page*& page);
+
+	/**
+	 * Allocates a new page like allocPage(file, PageNo, page), but returns a guard that unpins it.
+	 *
+	 * @param file   	File object
+	 * @param PageNo  Page number. The number assigned to the page in the file is returned via this reference.
+	 * @return  Guard holding the pinned page
+	 */
+  PageGuard allocPage(File* file, PageId &PageNo);
+
+	/**
+	 * Allocates a new page like allocPage(file, PageNo, page) and gives it a priority, as
+	 * setPriority() does.
+	 *
+	 * @param file   	File object
+	 * @param PageNo  Page number. The number assigned to the page in the file is returned via this reference.
+	 * @param page  	Reference to page pointer. The newly allocated in-memory Page object is returned via this reference.
+	 * @param priority	Priority of the page
+	 */
+  void allocPage(File* file, PageId &PageNo, Page*& page, const PagePriority priority);
+
+	/**
+	 * Sets how hard the pool tries to keep a resident page, such as an index root or a catalog
+	 * page, without pinning it. A HIGH page is passed over the next few times the replacement
+	 * policy picks it; setting HIGH again renews that. A STICKY page is never picked until its
+	 * priority is set back to NORMAL or HIGH, so a pool of sticky pages runs out of frames like a
+	 * pinned one. Unlike a pin, neither stops flushFile(), invalidateFile() or disposePage(), which
+	 * drop the page and its priority with it. A page that is read in again starts out NORMAL.
+	 *
+	 * @param file   	File object
+	 * @param PageNo  Page number in the file
+	 * @param priority	New priority of the page
+	 * @return  false if the page is not in the buffer pool, which is then left alone
+	 */
+  bool setPriority(const File* file, const PageId PageNo, const PagePriority priority);
+
+	/**
+	 * Writes out all dirty pages of the file to disk.
+	 * Only the frames holding pages of the file are visited, not the whole pool.
+	 * Dirty pages are written in page number order, runs of consecutive pages with one write each,
+	 * and the file is synced once at the end.
+	 * All the frames assigned to the file need to be unpinned from buffer pool before this function can be successfully called.
+	 * Otherwise Error returned.
+	 *
+	 * @param file   	File object
+   * @throws  PagePinnedException If any page of the file is pinned in the buffer pool 
+   * @throws BadBufferException If any frame allocated to the file is found to be invalid
+	 */
+  void flushFile(const File* file);
+
+	/**
+	 * Sets the loop readPageAsync(), allocPageAsync() and flushFileAsync() run their disk I/O
+	 * through, so that a coroutine waiting for a page is suspended while the thread it ran on
+	 * goes on with other work. Without a loop they block like the calls they are named after.
+	 * Call before the pool is shared between threads.
+	 *
+	 * @param loop				Loop supplied by the caller, which must outlive the calls; NULL for none
+	 */
+  void setEventLoop(EventLoop* loop);
+
+	/**
+	 * Reads a page like readPage(). A page that is in the pool and loaded is pinned at once
+	 * without suspending; otherwise the whole read, waiting for a frame included, runs through
+	 * the event loop while the calling coroutine is suspended.
+	 *
+	 * @param file   	File object
+	 * @param pageNo  Page number
+	 * @return	Task giving the address of the pinned page
+	 * @throws  InvalidPageException, BufferExceededException as readPage() does, from co_await
+	 */
+  Task<Page*> readPageAsync(File* file, const PageId pageNo);
+
+	/**
+	 * Allocates a page like allocPage(), with the allocation and its I/O run through the event
+	 * loop while the calling coroutine is suspended.
+	 *
+	 * @param file   	File object
+	 * @param pageNo  Page number of the new page, set when the task is done; must outlive it
+	 * @return	Task giving the address of the pinned page
+	 * @throws  BufferExceededException as allocPage() does, from co_await
+	 */
+  Task<Page*> allocPageAsync(File* file, PageId& pageNo);
+
+	/**
+	 * Flushes a file like flushFile(), with the write-back run through the event loop while the
+	 * calling coroutine is suspended.
+	 *
+	 * @param file   	File object
+	 * @return	Task that is done once the file's pages are written and dropped
+	 * @throws  PagePinnedException, BadBufferException as flushFile() does, from co_await
+	 */
+  Task<void> flushFileAsync(const File* file);
+
+	/**
+	 * Drops all pages of the file from the buffer pool without writing them, for a file that is
+	 * being deleted. Costs time in the number of the file's pages in the pool, not the pool size.
+	 *
+	 * @param file   	File object
+   * @throws  PagePinnedException If any page of the file is pinned in the buffer pool
+	 */
+  void invalidateFile(const File* file);
+
+	/**
+	 * Number of pages of the file currently in the buffer pool
+	 *
+	 * @param file   	File object
+	 */
+  std::uint32_t residentPages(const File* file);
+
+	/**
+	 * Puts file in a named group of files that share one quota, such as the tables of one tenant,
+	 * moving its resident pages out of the group it was in before. A group that has never been
+	 * given a quota has no limits.
+	 *
+	 * @param file   	File object
+	 * @param group   	Name of the group
+	 */
+  void setFileGroup(const File* file, const std::string& group);
+
+	/**
+	 * Limits the frames a group of files holds. Until the group holds maxFrames, a miss on one of
+	 * its files takes a victim from anywhere; from then on it evicts one of the group's own
+	 * pages, or fails with every one of them pinned. Misses of other groups pass over the
+	 * group's pages while it holds no more than minFrames, unless nothing else is unpinned, and
+	 * evict from it first while it holds more than maxFrames, as after the quota is lowered.
+	 * Misses racing on other threads can take a group a frame or two past its quota for a
+	 * moment.
+	 *
+	 * @param group   	Name of the group; made if it does not exist yet
+	 * @param minFrames	Frames reserved for the group
+	 * @param maxFrames	Most frames the group may hold
+	 * @throws  InvalidQuotaException if maxFrames is zero or less than minFrames
+	 */
+  void setQuota(const std::string& group, const std::uint32_t minFrames, const std::uint32_t maxFrames);
+
+	/**
+	 * Gives one file a quota of its own, by putting it in a group named after the file.
+	 *
+	 * @param file   	File object
+	 * @param minFrames	Frames reserved for the file
+	 * @param maxFrames	Most frames the file's pages may hold
+	 * @throws  InvalidQuotaException if maxFrames is zero or less than minFrames
+	 */
+  void setQuota(const File* file, const std::uint32_t minFrames, const std::uint32_t maxFrames);
+
+	/**
+	 * Number of frames holding pages of the files in a group
+	 *
+	 * @param group   	Name of the group
+	 */
+  std::uint32_t groupFrames(const std::string& group);
+
+	/**
+	 * Delete page from file and also from buffer pool if present.
+	 * Since the page is entirely deleted from file, its unnecessary to see if the page is dirty.
+	 *
+	 * @param file   	File object
+	 * @param PageNo  Page number
+	 */
+  void disposePage(File* file, const PageId PageNo);
+
+	/**
+	 * Starts reading the given pages of file into the buffer pool and returns at once. Pages are
+	 * loaded unpinned, in order, by a single prefetch thread; pages already in the pool are skipped.
+	 * A readPage() of a page still on its way waits for it rather than reading it again. Pages that
+	 * cannot be read, or that find every frame pinned, are silently dropped.
+	 *
+	 * @param file   	File object
+	 * @param pages  	Page numbers to read
+	 * @param n  			Number of entries in pages
+	 */
+  void prefetch(File* file, const PageId* pages, const std::size_t n);
+
+	/**
+	 * Writes a manifest of the pages in the buffer pool, hottest first: pinned pages, then the rest
+	 * in the reverse of the order the replacement policy would evict them. Pages are named by file
+	 * name and page number, so the manifest outlives the File objects. It is written to a temporary
+	 * file and renamed into place, so a crash midway leaves the previous manifest intact.
+	 *
+	 * @param manifestName		Path of the manifest
+	 * @return  Number of pages listed
+	 * @throws  InvalidManifestException if the manifest cannot be written
+	 */
+  std::size_t dumpResidentPages(const std::string& manifestName);
+
+	/**
+	 * Starts reading the pages listed in a manifest from dumpResidentPages() back into the pool and
+	 * returns at once. Only pages of the given files, matched by name, are loaded, and only the
+	 * hottest that fit in the pool. They are handed to the prefetch thread sorted by file and page
+	 * number, so each file is read from front to back rather than in the order it was used.
+	 *
+	 * @param manifestName		Path of the manifest
+	 * @param files					Open files whose pages may be loaded
+	 * @return  Number of pages queued
+	 * @throws  InvalidManifestException if the manifest cannot be read or is not a manifest
+	 */
+  std::size_t loadResidentPages(const std::string& manifestName, const std::vector<File*>& files);
+
+	/**
+	 * Keeps a compressed copy of every page evicted from the pool, in at most capacity bytes, and
+	 * serves misses from it before going to the file. Replaces any tier enabled earlier. Call
+	 * before the pool is shared between threads.
+	 *
+	 * @param capacity			Most bytes the compressed copies may take up; 0 to turn the tier off
+	 */
+  void enableCompressedTier(const std::size_t capacity);
+
+	/**
+   * Number of pages held by the compressed tier
+	 */
+  std::size_t compressedPages() const
+  {
+		return compressedTier == NULL ? 0 : compressedTier->pages();
+  }
+
+	/**
+	 * Keeps a copy of every page evicted from the pool in a cache file, meant for storage faster
+	 * than the database files', and serves misses from it before going to the file. Pages are
+	 * found by file name and page number, so a cache file reopened with the same number of pages
+	 * still serves the pages it held. The cache file must be deleted whenever a database file is
+	 * changed by anything but a BufMgr using it. Replaces any cache enabled earlier. Call before
+	 * the pool is shared between threads.
+	 *
+	 * @param path					Name of the cache file
+	 * @param numPages			Number of pages the cache file holds; 0 to turn the cache off
+	 * @throws  SecondaryCacheException if the cache file cannot be opened or sized
+	 */
+  void enableSecondaryCache(const std::string& path, const std::size_t numPages);
+
+	/**
+   * Number of pages held by the secondary cache
+	 */
+  std::size_t secondaryPages() const
+  {
+		return secondaryCache == NULL ? 0 : secondaryCache->pages();
+  }
+
+	/**
+	 * Makes the destructor write a manifest of the resident pages, for loadResidentPages() on the
+	 * next start. Errors writing it are ignored. Call before the pool is shared between threads.
+	 *
+	 * @param manifestName		Path of the manifest; empty to write none
+	 */
+  void dumpOnShutdown(const std::string& manifestName)
+  {
+		shutdownManifest = manifestName;
+  }
+
+	/**
+	 * Starts a thread that writes dirty, unpinned pages back to disk ahead of eviction. Each round
+	 * it asks the replacement policy for its next cleanTarget victims and writes out the dirty ones.
+	 * While more than dirtyHighWater of the pool is dirty it writes every dirty victim it is offered,
+	 * and threads unpinning pages dirty wait for it to get through a round. Restarts the writer with
+	 * the new settings if it is already running.
+	 *
+	 * @param cleanTarget			Number of next victims to keep clean
+	 * @param dirtyHighWater	Fraction of the pool that may be dirty before dirtiers are throttled
+	 * @param interval				Time between rounds
+	 */
+  void startBackgroundWriter(const std::uint32_t cleanTarget, const double dirtyHighWater = 0.5,
+                             const std::chrono::milliseconds interval = std::chrono::milliseconds(10));
+
+	/**
+	 * Stops the background writer and waits for it to exit. Does nothing if it is not running.
+	 */
+  void stopBackgroundWriter();
+
+	/**
+	 * Grows or shrinks the buffer pool to newBufs frames while it is in use. Growing hands the new
+	 * frames to the replacement policy at once. Shrinking drains the frames at the top of the pool
+	 * one by one: each is written back if dirty and unhashed as soon as it is unpinned, and the
+	 * call waits for pages pinned there to be unpinned. Memory of released frames goes back to
+	 * the system.
+	 *
+	 * @param newBufs				New number of frames
+	 * @throws  InvalidPoolSizeException if newBufs is zero or above the maxBufs the pool was made with
+	 */
+  void resize(const std::uint32_t newBufs);
+
+	/**
+	 * Sets how many victims a miss claims when it has to ask the replacement policy for a frame.
+	 * Claimed frames beyond the one the miss needs are kept, empty, in a reservoir that the next
+	 * misses take from without a search, so the cost of a search is shared by batch misses. With
+	 * the default of 1 nothing is kept. Frames the reservoir holds beyond a smaller new batch are
+	 * handed back to the policy.
+	 *
+	 * @param batch				Victims claimed per search; 0 is taken as 1
+	 */
+  void setVictimBatch(const std::uint32_t batch);
+
+	/**
+   * Number of empty frames waiting in the victim reservoir
+	 */
+  std::uint32_t reservedFrames();
+
+	/**
+   * Number of frames currently in the buffer pool
+	 */
+  std::uint32_t poolSize() const
+  {
+		return numBufs.load();
+  }
+
+	/**
+   * Most frames the buffer pool can be resized to
+	 */
+  std::uint32_t poolCapacity() const
+  {
+		return maxBufs;
+  }
+
+	/**
+   * True if the frames are backed by huge pages
+	 */
+  bool usingHugePages() const
+  {
+		return arena->hugePages();
+  }
+
+	/**
+   * Number of frames currently holding a dirty page
+	 */
+  std::uint32_t dirtyFrameCount() const
+  {
+		return dirtyFrames.load();
+  }
+
+	/**
+   * Print member variable values. 
+	 */
+  void  printSelf();
+
+	/**
+   * Get buffer pool usage statistics
+	 */
+  BufStats getBufStats() const
+  {
+		return bufStats.total();
+  }
+
+	/**
+   * Get buffer pool usage statistics of the pool and of every file it has seen. Subtract an
+   * earlier snapshot to get the counts of an interval, and use writeText() to export them.
 	 */
-  BufStats & getBufStats()
+  BufStatsSnapshot snapshotBufStats() const
   {
-		return bufStats;
+		return bufStats.snapshot();
   }
 
 	/**
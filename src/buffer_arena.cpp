@@ -0,0 +1,88 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "buffer_arena.h"
+
+#include <sys/mman.h>
+
+#include <cstdint>
+#include <new>
+
+namespace badgerdb {
+
+namespace {
+
+void* mapAnonymous(const std::size_t length, const int extraFlags) {
+  return mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | extraFlags, -1, 0);
+}
+
+}
+
+BufferArena::BufferArena(const std::size_t numFrames, const HugePageMode mode)
+    : base(NULL), length(numFrames * Page::SIZE), usingHugePages(false), transparent(false) {
+  if (length == 0) {
+    length = Page::SIZE;
+  }
+
+#ifdef MAP_HUGETLB
+  if (mode == HugePageMode::EXPLICIT) {
+    const std::size_t hugeLength = (length + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    void* mapped = mapAnonymous(hugeLength, MAP_HUGETLB);
+    if (mapped != MAP_FAILED) {
+      base = static_cast<char*>(mapped);
+      length = hugeLength;
+      usingHugePages = true;
+      return;
+    }
+  }
+#endif
+
+#ifdef MADV_HUGEPAGE
+  if (mode == HugePageMode::TRANSPARENT) {
+    // map an extra huge page so the arena can start on a huge page boundary, then trim
+    const std::size_t hugeLength = (length + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    void* mapped = mapAnonymous(hugeLength + HUGE_PAGE_SIZE, MAP_NORESERVE);
+    if (mapped == MAP_FAILED) {
+      throw std::bad_alloc();
+    }
+    char* raw = static_cast<char*>(mapped);
+    const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(raw);
+    char* aligned = raw + (HUGE_PAGE_SIZE - address % HUGE_PAGE_SIZE) % HUGE_PAGE_SIZE;
+    if (aligned > raw) {
+      munmap(raw, aligned - raw);
+    }
+    const std::size_t tail = (raw + hugeLength + HUGE_PAGE_SIZE) - (aligned + hugeLength);
+    if (tail > 0) {
+      munmap(aligned + hugeLength, tail);
+    }
+    base = aligned;
+    length = hugeLength;
+    transparent = true;
+    usingHugePages = madvise(base, length, MADV_HUGEPAGE) == 0;
+    return;
+  }
+#endif
+
+  void* mapped = mapAnonymous(length, MAP_NORESERVE);
+  if (mapped == MAP_FAILED) {
+    throw std::bad_alloc();
+  }
+  base = static_cast<char*>(mapped);
+}
+
+void BufferArena::release(const FrameId first, const std::size_t count) {
+  if (usingHugePages && !transparent) {
+    return;
+  }
+  madvise(frame(first), count * Page::SIZE, MADV_DONTNEED);
+}
+
+BufferArena::~BufferArena() {
+  munmap(base, length);
+}
+
+}
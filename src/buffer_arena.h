@@ -0,0 +1,106 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include "page.h"
+#include "types.h"
+
+namespace badgerdb {
+
+/**
+ * @brief How the buffer pool's memory is backed.
+ */
+enum class HugePageMode {
+  NONE,         /**< Ordinary pages */
+  TRANSPARENT,  /**< Ask the kernel for transparent huge pages */
+  EXPLICIT      /**< Reserved huge pages, falling back to ordinary pages if none are free */
+};
+
+/**
+ * @brief One contiguous, page-aligned block of memory holding every frame of the buffer pool.
+ *
+ * Frame i occupies Page::SIZE bytes starting at frame(i). The memory is mapped anonymously, so it
+ * starts out zeroed and is aligned to at least 4 KiB. Ordinary and transparent huge page mappings
+ * are not backed until touched, so an arena can be made for the largest size the pool may grow to
+ * and only the frames in use cost memory.
+ */
+class BufferArena {
+ public:
+  /**
+   * Maps memory for the given number of frames.
+   *
+   * @param numFrames   Number of frames in the buffer pool
+   * @param mode        Huge page backing to ask for
+   * @throws  std::bad_alloc  If the memory cannot be mapped
+   */
+  BufferArena(const std::size_t numFrames, const HugePageMode mode);
+
+  /**
+   * Unmaps the memory.
+   */
+  ~BufferArena();
+
+  BufferArena(const BufferArena&) = delete;
+  BufferArena& operator=(const BufferArena&) = delete;
+
+  /**
+   * Returns the first byte of a frame.
+   *
+   * @param frame   Frame number
+   */
+  char* frame(const FrameId frame) const {
+    return base + static_cast<std::size_t>(frame) * Page::SIZE;
+  }
+
+  /**
+   * Gives the memory of a run of frames back to the system. The frames read as zeroes if they are
+   * used again. Explicit huge pages are kept.
+   *
+   * @param first   First frame of the run
+   * @param count   Number of frames in the run
+   */
+  void release(const FrameId first, const std::size_t count);
+
+  /**
+   * Returns true if the memory is backed by explicit huge pages, or transparent huge pages were
+   * asked for and the kernel accepted the advice.
+   */
+  bool hugePages() const {
+    return usingHugePages;
+  }
+
+ private:
+  /**
+   * Size of the huge pages the arena is aligned to
+   */
+  static const std::size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+  /**
+   * Start of the mapping
+   */
+  char* base;
+
+  /**
+   * Length of the mapping in bytes
+   */
+  std::size_t length;
+
+  /**
+   * True if the mapping is backed by huge pages
+   */
+  bool usingHugePages;
+
+  /**
+   * True if the huge pages were asked for with madvise rather than reserved
+   */
+  bool transparent;
+};
+
+}
@@ -0,0 +1,72 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "file.h"
+#include "types.h"
+
+namespace badgerdb {
+
+class BufMgr;
+
+/**
+ * @brief Small set of frames a large sequential read cycles through, so that it does not push
+ *        the rest of the buffer pool out.
+ *
+ * Pass the ring to BufMgr::readPage() for every page of the scan. A page that is not in the pool
+ * is read into the frame the ring used a full lap earlier, as long as that frame still holds the
+ * page the ring put there and nobody has it pinned; only otherwise is a victim taken from the
+ * replacement policy. Pages that are already in the pool are used where they are. A ring belongs
+ * to one thread and one BufMgr at a time, and should hold a few more frames than the scan keeps
+ * pinned at once.
+ */
+class BufferRing {
+ public:
+  /**
+   * Constructs an empty ring.
+   *
+   * @param size  Number of frames the ring may hold; at least one
+   */
+  explicit BufferRing(const std::uint32_t size)
+      : slots(size == 0 ? 1 : size), next(0) {}
+
+  /**
+   * Returns the number of frames the ring may hold.
+   */
+  std::uint32_t size() const {
+    return slots.size();
+  }
+
+ private:
+  friend class BufMgr;
+
+  /**
+   * A frame of the ring and the page the ring last read into it
+   */
+  struct Slot {
+    Slot() : frameNo(~0u), fileId(File::INVALID_ID), pageNo(0) {}
+
+    FrameId frameNo;
+    FileId fileId;
+    PageId pageNo;
+  };
+
+  /**
+   * Frames in the order they are reused
+   */
+  std::vector<Slot> slots;
+
+  /**
+   * Slot the next miss goes into
+   */
+  std::uint32_t next;
+};
+
+}
@@ -0,0 +1,186 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "buffer_stats.h"
+
+#include <atomic>
+
+#include "file.h"
+
+namespace badgerdb {
+
+namespace {
+
+/**
+ * Field and export name of each counter, in BufCounter order
+ */
+struct CounterField {
+  std::uint64_t BufStats::*field;
+  const char* name;
+};
+
+const CounterField COUNTER_FIELDS[] = {
+  {&BufStats::accesses, "accesses"},
+  {&BufStats::hits, "hits"},
+  {&BufStats::misses, "misses"},
+  {&BufStats::diskreads, "disk_reads"},
+  {&BufStats::diskwrites, "disk_writes"},
+  {&BufStats::cleanEvictions, "clean_evictions"},
+  {&BufStats::dirtyEvictions, "dirty_evictions"},
+  {&BufStats::flushWrites, "flush_writes"},
+  {&BufStats::writerWrites, "writer_writes"},
+  {&BufStats::allocs, "allocs"},
+  {&BufStats::disposes, "disposes"},
+  {&BufStats::pinWaits, "pin_waits"},
+  {&BufStats::sweepSteps, "sweep_steps"},
+  {&BufStats::compressedHits, "compressed_hits"},
+  {&BufStats::secondaryHits, "secondary_hits"},
+};
+
+const std::size_t NUM_COUNTERS = static_cast<std::size_t>(BufCounter::COUNT);
+
+static_assert(sizeof(COUNTER_FIELDS) / sizeof(COUNTER_FIELDS[0]) == NUM_COUNTERS,
+              "every BufCounter needs a field");
+
+/**
+ * Hands each new thread the next shard in turn
+ */
+std::atomic<std::size_t> nextShard(0);
+
+void writeCounters(std::ostream& out, const BufStats& stats, const std::string& label) {
+  for (std::size_t i = 0; i < NUM_COUNTERS; i++) {
+    out << "badgerdb_buffer_" << COUNTER_FIELDS[i].name << label << " "
+        << stats.*COUNTER_FIELDS[i].field << "\n";
+  }
+}
+
+}
+
+std::uint64_t& BufStats::operator[](const BufCounter counter) {
+  return this->*COUNTER_FIELDS[static_cast<std::size_t>(counter)].field;
+}
+
+std::uint64_t BufStats::operator[](const BufCounter counter) const {
+  return this->*COUNTER_FIELDS[static_cast<std::size_t>(counter)].field;
+}
+
+const char* BufStats::name(const BufCounter counter) {
+  return COUNTER_FIELDS[static_cast<std::size_t>(counter)].name;
+}
+
+BufStats& BufStats::operator+=(const BufStats& other) {
+  for (std::size_t i = 0; i < NUM_COUNTERS; i++) {
+    this->*COUNTER_FIELDS[i].field += other.*COUNTER_FIELDS[i].field;
+  }
+  return *this;
+}
+
+BufStats BufStats::operator-(const BufStats& earlier) const {
+  BufStats diff(*this);
+  for (std::size_t i = 0; i < NUM_COUNTERS; i++) {
+    diff.*COUNTER_FIELDS[i].field -= earlier.*COUNTER_FIELDS[i].field;
+  }
+  return diff;
+}
+
+void BufStats::clear() {
+  for (std::size_t i = 0; i < NUM_COUNTERS; i++) {
+    this->*COUNTER_FIELDS[i].field = 0;
+  }
+}
+
+BufStatsSnapshot BufStatsSnapshot::operator-(const BufStatsSnapshot& earlier) const {
+  BufStatsSnapshot diff;
+  diff.total = total - earlier.total;
+  for (std::map<std::string, BufStats>::const_iterator it = files.begin(); it != files.end(); ++it) {
+    std::map<std::string, BufStats>::const_iterator before = earlier.files.find(it->first);
+    diff.files[it->first] = before == earlier.files.end() ? it->second : it->second - before->second;
+  }
+  return diff;
+}
+
+void BufStatsSnapshot::writeText(std::ostream& out) const {
+  writeCounters(out, total, "");
+  for (std::map<std::string, BufStats>::const_iterator it = files.begin(); it != files.end(); ++it) {
+    writeCounters(out, it->second, "{file=\"" + it->first + "\"}");
+  }
+}
+
+BufMetrics::BufMetrics() {
+  for (std::size_t i = 0; i < NUM_SHARDS; i++) {
+    shards[i] = new Shard;
+  }
+}
+
+BufMetrics::~BufMetrics() {
+  for (std::size_t i = 0; i < NUM_SHARDS; i++) {
+    delete shards[i];
+  }
+}
+
+BufMetrics::Shard& BufMetrics::shardOf() {
+  // fixed for the life of the thread, and shared by every BufMetrics it counts in
+  static thread_local const std::size_t shard = nextShard.fetch_add(1) % NUM_SHARDS;
+  return *shards[shard];
+}
+
+void BufMetrics::add(const BufCounter counter, const File* file, const std::uint64_t n) {
+  if (file == NULL) {
+    Shard& shard = shardOf();
+    std::lock_guard<std::mutex> guard(shard.latch);
+    shard.total[counter] += n;
+    return;
+  }
+  add(counter, file->id(), file->filename(), n);
+}
+
+void BufMetrics::add(const BufCounter counter, const FileId fileId, const std::string& fileName,
+                     const std::uint64_t n) {
+  Shard& shard = shardOf();
+  std::lock_guard<std::mutex> guard(shard.latch);
+  shard.total[counter] += n;
+  // keyed by ID rather than address: every handle on a file shares its ID, and a file opened
+  // later never reuses one, wherever its File object lands
+  std::unordered_map<FileId, FileCounts>::iterator it = shard.files.find(fileId);
+  if (it == shard.files.end()) {
+    it = shard.files.insert(std::make_pair(fileId, FileCounts())).first;
+    it->second.name = fileName;
+  }
+  it->second.stats[counter] += n;
+}
+
+BufStats BufMetrics::total() const {
+  BufStats sum;
+  for (std::size_t i = 0; i < NUM_SHARDS; i++) {
+    std::lock_guard<std::mutex> guard(shards[i]->latch);
+    sum += shards[i]->total;
+  }
+  return sum;
+}
+
+BufStatsSnapshot BufMetrics::snapshot() const {
+  BufStatsSnapshot snap;
+  for (std::size_t i = 0; i < NUM_SHARDS; i++) {
+    std::lock_guard<std::mutex> guard(shards[i]->latch);
+    snap.total += shards[i]->total;
+    for (std::unordered_map<FileId, FileCounts>::const_iterator it = shards[i]->files.begin();
+         it != shards[i]->files.end(); ++it) {
+      snap.files[it->second.name] += it->second.stats;
+    }
+  }
+  return snap;
+}
+
+void BufMetrics::clear() {
+  for (std::size_t i = 0; i < NUM_SHARDS; i++) {
+    std::lock_guard<std::mutex> guard(shards[i]->latch);
+    shards[i]->total.clear();
+    shards[i]->files.clear();
+  }
+}
+
+}
@@ -0,0 +1,294 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+#include "types.h"
+
+namespace badgerdb {
+
+class File;
+
+/**
+ * @brief Events BufMgr counts.
+ */
+enum class BufCounter {
+  ACCESSES,         /**< Pages asked for by readPage, readPages or allocPage */
+  HITS,             /**< Accesses that found the page in the pool */
+  MISSES,           /**< Accesses that had to read the page in */
+  DISK_READS,       /**< Pages read from disk, including prefetches and allocs */
+  DISK_WRITES,      /**< Pages written back to disk, for any reason */
+  CLEAN_EVICTIONS,  /**< Victims that were clean when taken */
+  DIRTY_EVICTIONS,  /**< Victims that had to be written back first */
+  FLUSH_WRITES,     /**< Pages written by flushFile */
+  WRITER_WRITES,    /**< Pages written by the background writer */
+  ALLOCS,           /**< Pages created by allocPage */
+  DISPOSES,         /**< Pages deleted by disposePage */
+  PIN_WAITS,        /**< Times a thread waited for I/O on a frame or for the writer to catch up */
+  SWEEP_STEPS,      /**< Frames the clock hand moved past looking for victims */
+  COMPRESSED_HITS,  /**< Misses served from the compressed tier instead of the file */
+  SECONDARY_HITS,   /**< Misses served from the secondary cache instead of the file */
+  COUNT             /**< Number of counters, not a counter */
+};
+
+/**
+* @brief Class to maintain statistics of buffer usage: the value of every BufCounter, for the
+*        whole pool or for one file.
+*/
+struct BufStats
+{
+	/**
+   * Total number of accesses to buffer pool
+	 */
+  std::uint64_t accesses;
+
+	/**
+   * Accesses that found the page in the buffer pool
+	 */
+  std::uint64_t hits;
+
+	/**
+   * Accesses that had to read the page from disk
+	 */
+  std::uint64_t misses;
+
+	/**
+   * Number of pages read from disk (including allocs)
+	 */
+  std::uint64_t diskreads;
+
+	/**
+   * Number of pages written back to disk
+	 */
+  std::uint64_t diskwrites;
+
+	/**
+   * Victims taken clean
+	 */
+  std::uint64_t cleanEvictions;
+
+	/**
+   * Victims written back before being taken
+	 */
+  std::uint64_t dirtyEvictions;
+
+	/**
+   * Pages written by flushFile
+	 */
+  std::uint64_t flushWrites;
+
+	/**
+   * Pages written by the background writer
+	 */
+  std::uint64_t writerWrites;
+
+	/**
+   * Pages created by allocPage
+	 */
+  std::uint64_t allocs;
+
+	/**
+   * Pages deleted by disposePage
+	 */
+  std::uint64_t disposes;
+
+	/**
+   * Waits for I/O on a frame or for the background writer
+	 */
+  std::uint64_t pinWaits;
+
+	/**
+   * Frames the clock hand moved past looking for victims
+	 */
+  std::uint64_t sweepSteps;
+
+	/**
+   * Misses served from the compressed tier instead of the file
+	 */
+  std::uint64_t compressedHits;
+
+	/**
+   * Misses served from the secondary cache instead of the file
+	 */
+  std::uint64_t secondaryHits;
+
+	/**
+   * Returns the field holding the given counter.
+	 */
+  std::uint64_t& operator[](const BufCounter counter);
+
+	/**
+   * Returns the field holding the given counter.
+	 */
+  std::uint64_t operator[](const BufCounter counter) const;
+
+	/**
+   * Name of the given counter in text exports
+	 */
+  static const char* name(const BufCounter counter);
+
+	/**
+   * Adds every counter of other to this one.
+	 */
+  BufStats& operator+=(const BufStats& other);
+
+	/**
+   * Counts since earlier, which must be an older copy of the same counters.
+	 */
+  BufStats operator-(const BufStats& earlier) const;
+
+	/**
+   * Clear all values
+	 */
+  void clear();
+
+	/**
+   * Constructor of BufStats class
+	 */
+  BufStats()
+  {
+		clear();
+  }
+};
+
+/**
+* @brief Counters of the whole pool and of every file it has seen, taken at one moment.
+*/
+struct BufStatsSnapshot
+{
+	/**
+   * Counters of the whole pool
+	 */
+  BufStats total;
+
+	/**
+   * Counters of each file, by file name
+	 */
+  std::map<std::string, BufStats> files;
+
+	/**
+   * Counts since earlier, an older snapshot of the same pool. Files earlier had not seen are
+   * reported in full.
+	 */
+  BufStatsSnapshot operator-(const BufStatsSnapshot& earlier) const;
+
+	/**
+	 * Writes every counter on a line of its own in the Prometheus text format, the pool's first and
+	 * then each file's, labelled with the file name:
+	 *
+	 *   badgerdb_buffer_hits 42
+	 *   badgerdb_buffer_hits{file="test.1"} 40
+	 *
+	 * @param out   Stream to write to
+	 */
+  void writeText(std::ostream& out) const;
+};
+
+/**
+* @brief Counters BufMgr bumps on its hot paths.
+*
+* Counts are kept in shards, and each thread sticks to one shard, so threads counting at once
+* rarely meet on a latch or share a cache line. Reading the counters adds up every shard.
+*/
+class BufMetrics
+{
+ public:
+	/**
+   * Constructor of BufMetrics class
+	 */
+  BufMetrics();
+
+	/**
+   * Destructor of BufMetrics class
+	 */
+  ~BufMetrics();
+
+  BufMetrics(const BufMetrics&) = delete;
+  BufMetrics& operator=(const BufMetrics&) = delete;
+
+	/**
+	 * Adds n to a counter of the pool and of file.
+	 *
+	 * @param counter   Counter to add to
+	 * @param file      File the event belongs to; NULL to count it for the pool only
+	 * @param n         Amount to add
+	 */
+  void add(const BufCounter counter, const File* file, const std::uint64_t n = 1);
+
+	/**
+	 * Adds n to a counter of the pool and of the file with the given ID, for a file known only by
+	 * its ID and name.
+	 *
+	 * @param counter   Counter to add to
+	 * @param fileId    ID of the file the event belongs to
+	 * @param fileName  Name of that file, recorded the first time it is counted
+	 * @param n         Amount to add
+	 */
+  void add(const BufCounter counter, const FileId fileId, const std::string& fileName,
+           const std::uint64_t n = 1);
+
+	/**
+   * Returns the counters of the whole pool.
+	 */
+  BufStats total() const;
+
+	/**
+   * Returns the counters of the whole pool and of every file.
+	 */
+  BufStatsSnapshot snapshot() const;
+
+	/**
+   * Sets every counter back to zero.
+	 */
+  void clear();
+
+ private:
+	/**
+   * Number of shards; threads beyond this many share
+	 */
+  static const std::size_t NUM_SHARDS = 16;
+
+	/**
+   * Counters of one file in one shard, with the name the file had when first counted
+	 */
+  struct FileCounts
+  {
+		std::string name;
+		BufStats stats;
+  };
+
+	/**
+   * Counters bumped by the threads assigned to one shard
+	 */
+  struct Shard
+  {
+		std::mutex latch;
+		BufStats total;
+		std::unordered_map<FileId, FileCounts> files;
+		char padding[64];
+  };
+
+	/**
+   * Shard of the calling thread
+	 */
+  Shard& shardOf();
+
+	/**
+   * Each shard is a separate allocation, so no two share a cache line
+	 */
+  Shard* shards[NUM_SHARDS];
+};
+
+}
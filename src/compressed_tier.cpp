@@ -0,0 +1,152 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "compressed_tier.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include "page.h"
+
+namespace badgerdb {
+
+namespace {
+
+/**
+ * Shortest run of zeros worth ending a literal run for
+ */
+const std::size_t MIN_ZERO_RUN = 8;
+
+void appendLength(std::string& out, const std::size_t length) {
+  const std::uint16_t value = static_cast<std::uint16_t>(length);
+  out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+std::size_t readLength(const std::string& in, std::size_t& pos) {
+  std::uint16_t value;
+  std::memcpy(&value, in.data() + pos, sizeof(value));
+  pos += sizeof(value);
+  return value;
+}
+
+}
+
+CompressedTier::CompressedTier(const std::size_t capacityIn)
+    : capacity(capacityIn), used(0) {}
+
+void CompressedTier::compress(const char* bytes, std::string& out) {
+  out.clear();
+  std::size_t pos = 0;
+  while (pos < Page::SIZE) {
+    // the literal run ends where a long enough run of zeros starts
+    std::size_t literalEnd = pos;
+    std::size_t zeroEnd = pos;
+    while (literalEnd < Page::SIZE) {
+      zeroEnd = literalEnd;
+      while (zeroEnd < Page::SIZE && bytes[zeroEnd] == 0) {
+        zeroEnd++;
+      }
+      if (zeroEnd - literalEnd >= MIN_ZERO_RUN || zeroEnd == Page::SIZE) {
+        break;
+      }
+      literalEnd = zeroEnd + 1;
+    }
+    if (literalEnd >= Page::SIZE) {
+      literalEnd = zeroEnd = Page::SIZE;
+    }
+    appendLength(out, literalEnd - pos);
+    out.append(bytes + pos, literalEnd - pos);
+    appendLength(out, zeroEnd - literalEnd);
+    pos = zeroEnd;
+  }
+}
+
+void CompressedTier::decompress(const std::string& in, char* bytes) {
+  std::size_t pos = 0;
+  std::size_t out = 0;
+  while (out < Page::SIZE) {
+    const std::size_t literal = readLength(in, pos);
+    std::memcpy(bytes + out, in.data() + pos, literal);
+    pos += literal;
+    out += literal;
+    const std::size_t zeros = readLength(in, pos);
+    std::memset(bytes + out, 0, zeros);
+    out += zeros;
+  }
+}
+
+void CompressedTier::put(const FileId file, const PageId pageNo, const char* bytes) {
+  std::string compressed;
+  compress(bytes, compressed);
+  const std::size_t charge = compressed.size() + ENTRY_OVERHEAD;
+  if (charge > capacity) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> guard(latch);
+  std::map<Key, Entry>::iterator it = entries.find(Key(file, pageNo));
+  if (it != entries.end()) {
+    erase(it);
+  }
+  while (used + charge > capacity) {
+    erase(entries.find(ages.back()));
+  }
+  ages.push_front(Key(file, pageNo));
+  Entry& entry = entries[Key(file, pageNo)];
+  entry.compressed.swap(compressed);
+  entry.age = ages.begin();
+  used += charge;
+}
+
+bool CompressedTier::take(const FileId file, const PageId pageNo, char* bytes) {
+  std::string compressed;
+  {
+    std::lock_guard<std::mutex> guard(latch);
+    std::map<Key, Entry>::iterator it = entries.find(Key(file, pageNo));
+    if (it == entries.end()) {
+      return false;
+    }
+    compressed = it->second.compressed;
+    erase(it);
+  }
+  decompress(compressed, bytes);
+  return true;
+}
+
+void CompressedTier::drop(const FileId file, const PageId pageNo) {
+  std::lock_guard<std::mutex> guard(latch);
+  std::map<Key, Entry>::iterator it = entries.find(Key(file, pageNo));
+  if (it != entries.end()) {
+    erase(it);
+  }
+}
+
+void CompressedTier::dropFile(const FileId file) {
+  std::lock_guard<std::mutex> guard(latch);
+  std::map<Key, Entry>::iterator it = entries.lower_bound(Key(file, 0));
+  while (it != entries.end() && it->first.first == file) {
+    erase(it++);
+  }
+}
+
+std::size_t CompressedTier::pages() const {
+  std::lock_guard<std::mutex> guard(latch);
+  return entries.size();
+}
+
+std::size_t CompressedTier::bytes() const {
+  std::lock_guard<std::mutex> guard(latch);
+  return used;
+}
+
+void CompressedTier::erase(std::map<Key, Entry>::iterator it) {
+  used -= it->second.compressed.size() + ENTRY_OVERHEAD;
+  ages.erase(it->second.age);
+  entries.erase(it);
+}
+
+}
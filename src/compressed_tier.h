@@ -0,0 +1,143 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "types.h"
+
+namespace badgerdb {
+
+/**
+ * @brief Bounded store of compressed copies of clean pages evicted from the buffer pool.
+ *
+ * BufMgr puts every page it evicts here and checks here on a miss before reading from the file.
+ * A slotted page keeps its free space between the slot array and the records zeroed, so pages
+ * are compressed by dropping runs of zero bytes; a mostly empty page shrinks to a few hundred
+ * bytes. When the compressed copies outgrow the capacity, the least recently stored are dropped.
+ * Copies are only ever of clean pages, so dropping one loses nothing. Every call is threadsafe.
+ */
+class CompressedTier {
+ public:
+  /**
+   * Constructs an empty tier.
+   *
+   * @param capacity  Most bytes the compressed copies may take up
+   */
+  explicit CompressedTier(const std::size_t capacity);
+
+  /**
+   * Stores a compressed copy of a page, replacing any older copy.
+   *
+   * @param file    ID of the page's file
+   * @param pageNo  Page number in the file
+   * @param bytes   Page::SIZE bytes of the page
+   */
+  void put(const FileId file, const PageId pageNo, const char* bytes);
+
+  /**
+   * Moves the copy of a page out of the tier, if there is one.
+   *
+   * @param file    ID of the page's file
+   * @param pageNo  Page number in the file
+   * @param bytes   Page::SIZE bytes the page is decompressed into
+   * @return  False if the tier has no copy of the page; bytes are left alone
+   */
+  bool take(const FileId file, const PageId pageNo, char* bytes);
+
+  /**
+   * Drops the copy of a page, if there is one.
+   *
+   * @param file    ID of the page's file
+   * @param pageNo  Page number in the file
+   */
+  void drop(const FileId file, const PageId pageNo);
+
+  /**
+   * Drops the copies of every page of a file.
+   *
+   * @param file    ID of the file whose pages to drop
+   */
+  void dropFile(const FileId file);
+
+  /**
+   * Returns the number of pages stored.
+   */
+  std::size_t pages() const;
+
+  /**
+   * Returns the bytes the stored copies take up, counting bookkeeping.
+   */
+  std::size_t bytes() const;
+
+ private:
+  /**
+   * Identity of a stored page
+   */
+  typedef std::pair<FileId, PageId> Key;
+
+  /**
+   * Compressed copy of a page and its place in the drop order
+   */
+  struct Entry {
+    std::string compressed;
+    std::list<Key>::iterator age;
+  };
+
+  /**
+   * Bytes an entry is charged on top of its compressed copy
+   */
+  static const std::size_t ENTRY_OVERHEAD = 64;
+
+  /**
+   * Encodes Page::SIZE bytes as alternating literal and zero runs, each preceded by its length.
+   */
+  static void compress(const char* bytes, std::string& out);
+
+  /**
+   * Reverses compress() into Page::SIZE bytes.
+   */
+  static void decompress(const std::string& in, char* bytes);
+
+  /**
+   * Removes an entry and its charge. Caller holds latch.
+   */
+  void erase(std::map<Key, Entry>::iterator it);
+
+  /**
+   * Most bytes the entries may be charged
+   */
+  const std::size_t capacity;
+
+  /**
+   * Bytes the entries are charged
+   */
+  std::size_t used;
+
+  /**
+   * Stored pages, ordered by file so that a file's pages are adjacent
+   */
+  std::map<Key, Entry> entries;
+
+  /**
+   * Stored pages, most recently stored first
+   */
+  std::list<Key> ages;
+
+  /**
+   * Guards all of the above
+   */
+  mutable std::mutex latch;
+};
+
+}
@@ -0,0 +1,41 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "badgerdb_exception.h"
+
+namespace badgerdb {
+
+/**
+ * @brief An exception that is thrown when a manifest of resident pages cannot be written, or cannot be read back.
+ */
+class InvalidManifestException : public BadgerDbException {
+ public:
+  /**
+   * Constructs an invalid manifest exception for the given manifest file.
+   *
+   * @param nameIn    Name of the manifest file
+   * @param reasonIn  What went wrong
+   */
+  explicit InvalidManifestException(const std::string& nameIn, const std::string& reasonIn);
+
+  /**
+   * Returns the name of the manifest file that caused this exception.
+   */
+  virtual const std::string& filename() const { return name; }
+
+ protected:
+  /**
+   * Name of the manifest file
+   */
+  const std::string name;
+};
+
+}
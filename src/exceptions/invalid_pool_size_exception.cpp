@@ -0,0 +1,22 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "invalid_pool_size_exception.h"
+
+#include <sstream>
+#include <string>
+
+namespace badgerdb {
+
+InvalidPoolSizeException::InvalidPoolSizeException(std::uint32_t requestedIn, std::uint32_t maxBufsIn)
+    : BadgerDbException(""), requested(requestedIn), maxBufs(maxBufsIn) {
+  std::stringstream ss;
+  ss << "Cannot resize the buffer pool to " << requested << " frames; it holds between 1 and " << maxBufs;
+  message_.assign(ss.str());
+}
+
+}
@@ -0,0 +1,39 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "badgerdb_exception.h"
+
+namespace badgerdb {
+
+/**
+ * @brief An exception that is thrown when the buffer pool is asked to resize beyond the capacity it was built with, or to nothing.
+ */
+class InvalidPoolSizeException : public BadgerDbException {
+ public:
+  /**
+   * Constructs an invalid pool size exception for the requested size.
+   */
+  explicit InvalidPoolSizeException(std::uint32_t requestedIn, std::uint32_t maxBufsIn);
+
+ protected:
+  /**
+   * Number of frames asked for
+   */
+  const std::uint32_t requested;
+
+  /**
+   * Most frames the pool can hold
+   */
+  const std::uint32_t maxBufs;
+};
+
+}
@@ -0,0 +1,24 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "invalid_quota_exception.h"
+
+#include <sstream>
+#include <string>
+
+namespace badgerdb {
+
+InvalidQuotaException::InvalidQuotaException(const std::string& groupIn, std::uint32_t minFramesIn,
+                                             std::uint32_t maxFramesIn)
+    : BadgerDbException(""), group(groupIn), minFrames(minFramesIn), maxFrames(maxFramesIn) {
+  std::stringstream ss;
+  ss << "Cannot give group " << group << " a reservation of " << minFrames << " frames and a quota of "
+     << maxFrames << "; the quota must be at least 1 and the reservation at most the quota";
+  message_.assign(ss.str());
+}
+
+}
@@ -0,0 +1,44 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "badgerdb_exception.h"
+
+namespace badgerdb {
+
+/**
+ * @brief An exception that is thrown when a group of files is given a quota of no frames, or a reservation above its quota.
+ */
+class InvalidQuotaException : public BadgerDbException {
+ public:
+  /**
+   * Constructs an invalid quota exception for the given group and limits.
+   */
+  explicit InvalidQuotaException(const std::string& groupIn, std::uint32_t minFramesIn, std::uint32_t maxFramesIn);
+
+ protected:
+  /**
+   * Name of the group of files
+   */
+  const std::string group;
+
+  /**
+   * Frames asked to be reserved
+   */
+  const std::uint32_t minFrames;
+
+  /**
+   * Most frames asked for
+   */
+  const std::uint32_t maxFrames;
+};
+
+}
@@ -0,0 +1,41 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "badgerdb_exception.h"
+
+namespace badgerdb {
+
+/**
+ * @brief An exception that is thrown when the file backing a secondary page cache cannot be opened or sized.
+ */
+class SecondaryCacheException : public BadgerDbException {
+ public:
+  /**
+   * Constructs a secondary cache exception for the given cache file.
+   *
+   * @param nameIn    Name of the cache file
+   * @param reasonIn  What went wrong
+   */
+  explicit SecondaryCacheException(const std::string& nameIn, const std::string& reasonIn);
+
+  /**
+   * Returns the name of the cache file that caused this exception.
+   */
+  virtual const std::string& filename() const { return name; }
+
+ protected:
+  /**
+   * Name of the cache file
+   */
+  const std::string name;
+};
+
+}
@@ -10,9 +10,13 @@
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <cstdio>
 #include <cassert>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include "exceptions/file_exists_exception.h"
 #include "exceptions/file_not_found_exception.h"
@@ -25,6 +29,9 @@ namespace badgerdb {
 
 File::StreamMap File::open_streams_;
 File::CountMap File::open_counts_;
+File::IdMap File::open_ids_;
+FileId File::next_id_ = File::INVALID_ID + 1;
+std::mutex File::registry_latch_;
 
 File File::create(const std::string& filename) {
   return File(filename, true /* create_new */);
@@ -48,6 +55,7 @@ bool File::isOpen(const std::string& filename) {
   if (!exists(filename)) {
     return false;
   }
+  std::lock_guard<std::mutex> guard(registry_latch_);
   return open_counts_.find(filename) != open_counts_.end();
 }
 
@@ -64,7 +72,9 @@ bool File::exists(const std::string& filename) {
 
 File::File(const File& other)
   : filename_(other.filename_),
-    stream_(open_streams_[filename_]) {
+    id_(other.id_) {
+  std::lock_guard<std::mutex> guard(registry_latch_);
+  stream_ = open_streams_[filename_];
   ++open_counts_[filename_];
 }
 
@@ -154,16 +164,35 @@ Page File::readPage(const PageId page_number) const {
   return readPage(page_number, false /* allow_free */);
 }
 
+void File::readPage(const PageId page_number, Page& page) const {
+  if (tryReadPage(page_number, page) != Status::OK) {
+    throw InvalidPageException(page_number, filename_);
+  }
+}
+
+Status File::tryReadPage(const PageId page_number, Page& page) const {
+  FileHeader header = readHeader();
+  if (page_number >= header.num_pages) {
+    return Status::INVALID_PAGE;
+  }
+  readPage(page_number, true /* allow_free */, page);
+  return page.isUsed() ? Status::OK : Status::INVALID_PAGE;
+}
+
 Page File::readPage(const PageId page_number, const bool allow_free) const {
   Page page;
+  readPage(page_number, allow_free, page);
+  return page;
+}
+
+void File::readPage(const PageId page_number, const bool allow_free,
+                    Page& page) const {
+  // The header and data are contiguous in memory, just as they are on disk.
   stream_->seekg(pagePosition(page_number), std::ios::beg);
-  stream_->read(reinterpret_cast<char*>(&page.header_), sizeof(page.header_));
-  stream_->read(&page.data_[0], Page::DATA_SIZE);
+  stream_->read(page.bytes_, Page::SIZE);
   if (!allow_free && !page.isUsed()) {
     throw InvalidPageException(page_number, filename_);
   }
-
-  return page;
 }
 
 void File::writePage(const Page& new_page) {
@@ -181,6 +210,40 @@ void File::writePage(const Page& new_page) {
   writePage(new_page.page_number(), header, new_page);
 }
 
+void File::writePages(const Page* const* pages, const std::size_t n) {
+  if (n == 0) {
+    return;
+  }
+  const PageId first_page_number = pages[0]->page_number();
+  std::unique_ptr<char[]> run(new char[n * Page::SIZE]);
+  for (std::size_t i = 0; i < n; ++i) {
+    // Same header rules as writePage(), applied to each page of the run.
+    PageHeader header = readPageHeader(first_page_number + i);
+    if (header.current_page_number == Page::INVALID_NUMBER) {
+      throw InvalidPageException(first_page_number + i, filename_);
+    }
+    const PageId next_page_number = header.next_page_number;
+    header = pages[i]->header_;
+    header.next_page_number = next_page_number;
+    char* slot = run.get() + i * Page::SIZE;
+    std::memcpy(slot, &header, sizeof(header));
+    std::memcpy(slot + sizeof(header), pages[i]->data_, Page::DATA_SIZE);
+  }
+  stream_->seekp(pagePosition(first_page_number), std::ios::beg);
+  stream_->write(run.get(), n * Page::SIZE);
+}
+
+void File::sync() {
+  stream_->flush();
+  // The stream does not expose its descriptor; syncing any descriptor of the
+  // file writes back all of its dirty data.
+  const int fd = ::open(filename_.c_str(), O_RDONLY);
+  if (fd >= 0) {
+    ::fsync(fd);
+    ::close(fd);
+  }
+}
+
 void File::deletePage(const PageId page_number) {
   FileHeader header = readHeader();
   Page existing_page = readPage(page_number);
@@ -232,9 +295,11 @@ File::File(const std::string& name, const bool create_new) : filename_(name) {
 }
 
 void File::openIfNeeded(const bool create_new) {
+  std::lock_guard<std::mutex> guard(registry_latch_);
   if (open_counts_.find(filename_) != open_counts_.end()) {	//exists an entry already
     ++open_counts_[filename_];
     stream_ = open_streams_[filename_];
+    id_ = open_ids_[filename_];
   } else {
     std::ios_base::openmode mode =
         std::fstream::in | std::fstream::out | std::fstream::binary;
@@ -255,15 +320,19 @@ void File::openIfNeeded(const bool create_new) {
     stream_.reset(new std::fstream(filename_, mode));
     open_streams_[filename_] = stream_;
     open_counts_[filename_] = 1;
+    id_ = next_id_++;
+    open_ids_[filename_] = id_;
   }
 }
 
 void File::close() {
+  std::lock_guard<std::mutex> guard(registry_latch_);
   --open_counts_[filename_];
   stream_.reset();
   if (open_counts_[filename_] == 0) {
     open_streams_.erase(filename_);
     open_counts_.erase(filename_);
+    open_ids_.erase(filename_);
   }
 }
 
@@ -275,7 +344,7 @@ void File::writePage(const PageId page_number, const PageHeader& header,
                      const Page& new_page) {
   stream_->seekp(pagePosition(page_number), std::ios::beg);
   stream_->write(reinterpret_cast<const char*>(&header), sizeof(header));
-  stream_->write(&new_page.data_[0], Page::DATA_SIZE);
+  stream_->write(new_page.data_, Page::DATA_SIZE);
   stream_->flush();
 }
 
@@ -11,6 +11,7 @@
 #include <string>
 #include <map>
 #include <memory>
+#include <mutex>
 
 #include "page.h"
 
@@ -68,7 +69,9 @@ struct FileHeader {
  * detects this (by looking in the open_streams_ map) and just returns a file object with
  * the already created stream for the file without actually opening the UNIX file again. 
  *
- * @warning This class is not threadsafe.
+ * @warning This class is not threadsafe, except that File objects may be created, copied and
+ *          destroyed from several threads at once; reads and writes on a shared stream must
+ *          still be serialized by the caller.
  */
 class File {
  public:
@@ -155,6 +158,30 @@ class File {
    */
   Page readPage(const PageId page_number) const;
 
+  /**
+   * Reads an existing page from the file straight into the bytes of the given
+   * page, which may be a view such as a buffer pool frame.  The contents of
+   * page are undefined if an exception is thrown.
+   *
+   * @param page_number   Number of page to read.
+   * @param page          Page to read into.
+   * @throws  InvalidPageException  If the page doesn't exist in the file or is
+   *                                not currently used.
+   */
+  void readPage(const PageId page_number, Page& page) const;
+
+  /**
+   * Reads an existing page like readPage(page_number, page), reporting a page
+   * that is not in the file or not currently used as a status rather than an
+   * exception.
+   *
+   * @param page_number   Number of page to read.
+   * @param page          Page to read into.
+   * @return  Status::OK, or Status::INVALID_PAGE, in which case the contents of
+   *          page are undefined.
+   */
+  Status tryReadPage(const PageId page_number, Page& page) const;
+
   /**
    * Writes a page into the file, replacing any existing contents.  The page
    * must have been already allocated in this file by a call to allocatePage().
@@ -164,6 +191,24 @@ class File {
    */
   void writePage(const Page& new_page);
 
+  /**
+   * Writes a run of pages with consecutive page numbers, starting at the page
+   * number of the first, with a single write.  Each page is handled as by
+   * writePage(), but the stream is not flushed; call sync() once the last run
+   * of a batch is written.
+   *
+   * @param pages   Pages to write, in page number order with no gaps.
+   * @param n       Number of pages in the run.
+   * @throws  InvalidPageException  If one of the pages has been deleted.
+   */
+  void writePages(const Page* const* pages, const std::size_t n);
+
+  /**
+   * Flushes the stream and waits for the operating system to put the file's
+   * contents on stable storage.
+   */
+  void sync();
+
   /**
    * Deletes a page from the file.
    *
@@ -178,6 +223,22 @@ class File {
    */
   const std::string& filename() const { return filename_; }
 
+  /**
+   * Returns the ID of the file this object represents.  Every File object open
+   * on the same file has the same ID, so it identifies the file rather than the
+   * object.  IDs are small integers handed out in the order files are opened,
+   * and a file closed by its last File object gets a new ID when it is opened
+   * again, so an ID never names two different files.
+   *
+   * @return ID of file.
+   */
+  FileId id() const { return id_; }
+
+  /**
+   * ID that no open file has.
+   */
+  static const FileId INVALID_ID = 0;
+
   /**
    * Returns an iterator at the first page in the file.
    *
@@ -256,6 +317,19 @@ class File {
    */
   Page readPage(const PageId page_number, const bool allow_free) const;
 
+  /**
+   * Reads a page from the file into the bytes of the given page, as
+   * readPage(page_number, allow_free) does.
+   *
+   * @param page_number   Number of page to read.
+   * @param allow_free    Whether to allow reading a free (unused) page.
+   * @param page          Page to read into.
+   * @throws  InvalidPageException  If the page is free (unused) and
+   *                                allow_free is false.
+   */
+  void readPage(const PageId page_number, const bool allow_free,
+                Page& page) const;
+
   /**
    * Writes a page into the file at the given page number.  This does not
    * update ensure that the number in the header equals the position on disk.
@@ -304,6 +378,7 @@ class File {
   typedef std::map<std::string,
                    std::shared_ptr<std::fstream> > StreamMap;
   typedef std::map<std::string, int> CountMap;
+  typedef std::map<std::string, FileId> IdMap;
 
   /**
    * Streams for opened files.
@@ -315,11 +390,31 @@ class File {
    */
   static CountMap open_counts_;
 
+  /**
+   * IDs of opened files.
+   */
+  static IdMap open_ids_;
+
+  /**
+   * ID the next file opened gets.
+   */
+  static FileId next_id_;
+
+  /**
+   * Latch guarding the maps above and next_id_.
+   */
+  static std::mutex registry_latch_;
+
   /**
    * Name of the file this object represents.
    */
   std::string filename_;
 
+  /**
+   * ID of the file this object represents.
+   */
+  FileId id_;
+
   /**
    * Stream for underlying filesystem object.
    */
@@ -2,9 +2,17 @@
 #include <stdlib.h>
 //#include <stdio.h>
 #include <cstring>
+#include <fstream>
 #include <memory>
+#include <sstream>
+#include <thread>
+#include <atomic>
+#include <vector>
 #include "page.h"
+#include "page_guard.h"
+#include "buffer_ring.h"
 #include "buffer.h"
+#include "bufHashTbl.h"
 #include "file_iterator.h"
 #include "page_iterator.h"
 #include "exceptions/file_not_found_exception.h"
@@ -14,6 +22,11 @@
 #include "exceptions/buffer_exceeded_exception.h"
 #include "exceptions/bad_buffer_exception.h"
 #include "exceptions/hash_not_found_exception.h"
+#include "exceptions/invalid_pool_size_exception.h"
+#include "exceptions/invalid_manifest_exception.h"
+#include "exceptions/invalid_quota_exception.h"
+#include "exceptions/secondary_cache_exception.h"
+#include "async.h"
 
 #define PRINT_ERROR(str) \
 { \
@@ -41,6 +54,31 @@ void test6();
 void test7();
 void test8();
 void test9();
+void test10();
+void test11();
+void test12();
+void test13();
+void test14();
+void test15();
+void test16();
+void test17();
+void test18();
+void test19();
+void test20();
+void test21();
+void test22();
+void test23();
+void test24();
+void test25();
+void test26();
+void test27();
+void test28();
+void test29();
+void test30();
+void test31();
+void test32();
+void test33();
+void test34();
 void testBufMgr();
 
 int main() 
@@ -79,12 +117,15 @@ int main()
     for (FileIterator iter = new_file.begin();
          iter != new_file.end();
          ++iter) {
-      // Iterate through all records on the page.
-      for (PageIterator page_iter = (*iter).begin();
-           page_iter != (*iter).end();
+      // Iterate through all records on the page.  The page is copied out of
+      // the iterator first so the record iterator does not point into a
+      // temporary.
+      Page curr_page = *iter;
+      for (PageIterator page_iter = curr_page.begin();
+           page_iter != curr_page.end();
            ++page_iter) {
         std::cout << "Found record: " << *page_iter
-            << " on page " << (*iter).page_number() << "\n";
+            << " on page " << curr_page.page_number() << "\n";
       }
     }
 
@@ -158,6 +199,31 @@ void testBufMgr()
 	test7();
 	test8();
     test9();
+	test10();
+	test11();
+	test12();
+	test13();
+	test14();
+	test15();
+	test16();
+	test17();
+	test18();
+	test19();
+	test20();
+	test21();
+	test22();
+	test23();
+	test24();
+	test25();
+	test26();
+	test27();
+	test28();
+	test29();
+	test30();
+	test31();
+	test32();
+	test33();
+	test34();
 
     delete bufMgr;
     
@@ -405,3 +471,1645 @@ void test9()
 }
 
 
+
+/**
+ *  Test10 has several threads pin and unpin pages of file1 at once. The working set is the whole
+ *  file, so threads race on clock evictions as well as on hits. Every page read must hold its own record.
+ */
+void test10()
+{
+	const int numThreads = 8;
+	const int iterations = 2000;
+	std::atomic<bool> mismatch(false);
+	std::vector<std::thread> workers;
+
+	for (int t = 0; t < numThreads; t++) {
+		workers.push_back(std::thread([t, &mismatch]() {
+			unsigned int seed = t;
+			char expected[100];
+			Page* threadPage;
+			for (int j = 0; j < iterations; j++) {
+				PageId pageNo = 1 + rand_r(&seed) % num;
+				bufMgr->readPage(file1ptr, pageNo, threadPage);
+				sprintf(expected, "test.1 Page %u %7.1f", pageNo, (float)pageNo);
+				RecordId recordId = {pageNo, 1};
+				if(strncmp(threadPage->getRecord(recordId).c_str(), expected, strlen(expected)) != 0)
+				{
+					mismatch = true;
+				}
+				bufMgr->unPinPage(file1ptr, pageNo, false);
+			}
+		}));
+	}
+	for (std::size_t t = 0; t < workers.size(); t++)
+		workers[t].join();
+
+	if(mismatch)
+	{
+		PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+	}
+
+	bufMgr->flushFile(file1ptr);
+
+	std::cout << "Test 10 passed" << "\n";
+}
+
+/**
+ *  Test11 fills a deliberately small hash table past its initial size, then removes every other
+ *  entry. Misses must be reported without exceptions and survivors must keep their frames.
+ */
+void test11()
+{
+	BufHashTbl table(16, 4);
+	const PageId entries = 1000;
+	FrameId frameNo;
+
+	for (PageId j = 1; j <= entries; j++) {
+		table.insert(j % 2 ? file1ptr : file2ptr, j, j + 7);
+	}
+	for (PageId j = 2; j <= entries; j += 2) {
+		table.remove(file2ptr, j);
+	}
+
+	for (PageId j = 1; j <= entries; j++) {
+		const bool found = table.tryLookup(j % 2 ? file1ptr : file2ptr, j, frameNo);
+		if (found != (j % 2 == 1) || (found && frameNo != j + 7))
+		{
+			PRINT_ERROR("ERROR :: HASH TABLE ENTRY WRONG AFTER REMOVALS");
+		}
+	}
+	if (table.tryLookup(file3ptr, 1, frameNo) || table.tryRemove(file2ptr, 2))
+	{
+		PRINT_ERROR("ERROR :: Entry should not be in the hash table.");
+	}
+
+	std::cout << "Test 11 passed" << "\n";
+}
+
+/**
+ *  Test12 runs a mix of hot pages and a scan of file1 through a small pool under every replacement
+ *  policy, first from one thread and then from several, then pins every frame and expects the
+ *  next read to be refused.
+ */
+void test12()
+{
+	const ReplacementPolicyType types[] = {ReplacementPolicyType::CLOCK, ReplacementPolicyType::LRU_K,
+		ReplacementPolicyType::TWO_Q, ReplacementPolicyType::ARC, ReplacementPolicyType::CLOCK_PRO};
+	const PageId poolSize = 10;
+
+	for (std::size_t t = 0; t < sizeof(types) / sizeof(types[0]); t++) {
+		BufMgr mgr(poolSize, types[t]);
+
+		for (PageId j = 0; j < 500; j++) {
+			PageId pageNo = (j % 2 == 0) ? 1 + (j / 2) % 3 : 4 + j % (num - 3);
+			mgr.readPage(file1ptr, pageNo, page);
+			sprintf((char*)tmpbuf, "test.1 Page %u %7.1f", pageNo, (float)pageNo);
+			RecordId recordId = {pageNo, 1};
+			if(strncmp(page->getRecord(recordId).c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+			{
+				PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+			}
+			mgr.unPinPage(file1ptr, pageNo, false);
+		}
+
+		// hits from several threads at once, which reach the policy without its latch
+		std::atomic<bool> mismatch(false);
+		std::vector<std::thread> workers;
+		for (int w = 0; w < 4; w++) {
+			workers.push_back(std::thread([w, &mgr, &mismatch]() {
+				unsigned int seed = w;
+				char expected[100];
+				Page* threadPage;
+				for (int j = 0; j < 300; j++) {
+					const PageId pageNo = (j % 2 == 0) ? 1 + rand_r(&seed) % 3 : 4 + rand_r(&seed) % 20;
+					mgr.readPage(file1ptr, pageNo, threadPage);
+					sprintf(expected, "test.1 Page %u %7.1f", pageNo, (float)pageNo);
+					RecordId threadRecord = {pageNo, 1};
+					if(strncmp(threadPage->getRecord(threadRecord).c_str(), expected, strlen(expected)) != 0)
+					{
+						mismatch = true;
+					}
+					mgr.unPinPage(file1ptr, pageNo, false);
+				}
+			}));
+		}
+		for (std::size_t w = 0; w < workers.size(); w++)
+			workers[w].join();
+		if (mismatch)
+		{
+			PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+		}
+
+		for (PageId j = 1; j <= poolSize; j++) {
+			mgr.readPage(file1ptr, j, page);
+		}
+		try
+		{
+			mgr.readPage(file1ptr, poolSize + 1, page);
+			PRINT_ERROR("ERROR :: No more frames left for allocation. Exception should have been thrown before execution reaches this point.");
+		}
+		catch(const BufferExceededException &e)
+		{
+		}
+		for (PageId j = 1; j <= poolSize; j++) {
+			mgr.unPinPage(file1ptr, j, false);
+		}
+		mgr.flushFile(file1ptr);
+	}
+
+	std::cout << "Test 12 passed" << "\n";
+}
+
+/**
+ *  Test13 dirties more pages of file2 than a small pool holds with the background writer running.
+ *  The writer must leave no dirty frames behind, and the file on disk must hold every update.
+ */
+void test13()
+{
+	const PageId pages = num/3;
+	RecordId updated[num];
+	bufMgr->flushFile(file2ptr);
+
+	BufMgr mgr(20);
+	mgr.startBackgroundWriter(20, 0.5, std::chrono::milliseconds(1));
+	for (PageId j = 1; j <= pages; j++) {
+		mgr.readPage(file2ptr, j, page);
+		sprintf((char*)tmpbuf, "test.13 Page %u %7.1f", j, (float)j);
+		updated[j - 1] = page->insertRecord(tmpbuf);
+		mgr.unPinPage(file2ptr, j, true);
+	}
+
+	for (int wait = 0; mgr.dirtyFrameCount() > 0 && wait < 5000; wait++) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	if (mgr.dirtyFrameCount() > 0)
+	{
+		PRINT_ERROR("ERROR :: Background writer left dirty frames behind.");
+	}
+	mgr.stopBackgroundWriter();
+
+	for (PageId j = 1; j <= pages; j++) {
+		Page onDisk = file2ptr->readPage(j);
+		sprintf((char*)tmpbuf, "test.13 Page %u %7.1f", j, (float)j);
+		if(strncmp(onDisk.getRecord(updated[j - 1]).c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+		{
+			PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+		}
+	}
+
+	std::cout << "Test 13 passed" << "\n";
+}
+
+/**
+ *  Test14 prefetches pages of file1, one of which does not exist, and reads them while they may still
+ *  be in flight. The missing page must be reported by readPage, and a flush straight after a prefetch
+ *  must find nothing pinned.
+ */
+void test14()
+{
+	BufMgr mgr(20);
+	PageId ahead[16];
+	for (PageId j = 0; j < 15; j++) {
+		ahead[j] = j + 1;
+	}
+	ahead[15] = num + 50;
+	mgr.prefetch(file1ptr, ahead, 16);
+
+	for (PageId j = 0; j < 15; j++) {
+		mgr.readPage(file1ptr, ahead[j], page);
+		sprintf((char*)tmpbuf, "test.1 Page %u %7.1f", ahead[j], (float)ahead[j]);
+		RecordId recordId = {ahead[j], 1};
+		if(strncmp(page->getRecord(recordId).c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+		{
+			PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+		}
+		mgr.unPinPage(file1ptr, ahead[j], false);
+	}
+	try
+	{
+		mgr.readPage(file1ptr, ahead[15], page);
+		PRINT_ERROR("ERROR :: Page does not exist. Exception should have been thrown before execution reaches this point.");
+	}
+	catch(const InvalidPageException &e)
+	{
+	}
+
+	for (PageId j = 0; j < 15; j++) {
+		ahead[j] = j + 16;
+	}
+	mgr.prefetch(file1ptr, ahead, 15);
+	mgr.flushFile(file1ptr);
+
+	std::cout << "Test 14 passed" << "\n";
+}
+
+/**
+ *  Test15 pins a batch of file1 pages with repeats, some of them already in the pool, and unpins it
+ *  as a batch. A batch that does not fit must leave nothing pinned behind.
+ */
+void test15()
+{
+	BufMgr mgr(20);
+	const std::size_t batch = 24;
+	PageKey keys[batch];
+	Page* pages[batch];
+
+	mgr.readPage(file1ptr, 3, page);
+	mgr.unPinPage(file1ptr, 3, false);
+	for (std::size_t j = 0; j < batch; j++) {
+		keys[j].file = file1ptr;
+		keys[j].pageNo = 1 + (j * 7) % 16;
+	}
+
+	mgr.readPages(keys, batch, pages);
+	for (std::size_t j = 0; j < batch; j++) {
+		sprintf((char*)tmpbuf, "test.1 Page %u %7.1f", keys[j].pageNo, (float)keys[j].pageNo);
+		RecordId recordId = {keys[j].pageNo, 1};
+		if(strncmp(pages[j]->getRecord(recordId).c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+		{
+			PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+		}
+	}
+	mgr.unPinPages(keys, batch, false);
+	try
+	{
+		mgr.unPinPages(keys, 1, false);
+		PRINT_ERROR("ERROR :: Page is already unpinned. Exception should have been thrown before execution reaches this point.");
+	}
+	catch(const PageNotPinnedException &e)
+	{
+	}
+
+	for (std::size_t j = 0; j < batch; j++) {
+		keys[j].pageNo = j + 1;
+	}
+	try
+	{
+		mgr.readPages(keys, batch, pages);
+		PRINT_ERROR("ERROR :: No more frames left for allocation. Exception should have been thrown before execution reaches this point.");
+	}
+	catch(const BufferExceededException &e)
+	{
+	}
+	mgr.flushFile(file1ptr);
+
+	std::cout << "Test 15 passed" << "\n";
+}
+
+/**
+ *  Test16 reads many more file1 pages through guards than a small pool holds without ever calling
+ *  unPinPage, moves a guard around, and dirties a page through one. Nothing may stay pinned.
+ */
+void test16()
+{
+	BufMgr mgr(5);
+	for (PageId j = 1; j <= num; j++) {
+		PageGuard guard = mgr.readPage(file1ptr, j);
+		sprintf((char*)tmpbuf, "test.1 Page %u %7.1f", j, (float)j);
+		RecordId recordId = {j, 1};
+		if(strncmp(guard->getRecord(recordId).c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+		{
+			PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+		}
+	}
+
+	PageGuard moved;
+	RecordId added;
+	{
+		PageGuard guard = mgr.readPage(file1ptr, 2);
+		added = guard->insertRecord("test.16 guarded");
+		guard.markDirty();
+		moved = std::move(guard);
+		if (guard || !moved || moved.page_number() != 2)
+		{
+			PRINT_ERROR("ERROR :: Guard was not moved.");
+		}
+	}
+	moved.release();
+	mgr.flushFile(file1ptr);
+
+	if (file1ptr->readPage(2).getRecord(added) != "test.16 guarded")
+	{
+		PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+	}
+
+	std::cout << "Test 16 passed" << "\n";
+}
+
+/**
+ *  Test17 keeps pages of two files in a pool and checks the per-file residency counts as pages of
+ *  one file are evicted, dirtied and finally dropped without being written back.
+ */
+void test17()
+{
+	BufMgr mgr(8);
+	for (PageId j = 1; j <= 3; j++) {
+		mgr.readPage(file3ptr, j, page);
+		mgr.unPinPage(file3ptr, j, false);
+	}
+	for (PageId j = 1; j <= 10; j++) {
+		mgr.readPage(file1ptr, j, page);
+		mgr.unPinPage(file1ptr, j, j == 10);
+	}
+	if (mgr.residentPages(file1ptr) + mgr.residentPages(file3ptr) != 8 || mgr.residentPages(file1ptr) < 5)
+	{
+		PRINT_ERROR("ERROR :: Wrong number of resident pages.");
+	}
+
+	mgr.invalidateFile(file1ptr);
+	if (mgr.residentPages(file1ptr) != 0 || mgr.dirtyFrameCount() != 0)
+	{
+		PRINT_ERROR("ERROR :: Pages of an invalidated file are still in the pool.");
+	}
+	const std::uint32_t file3Pages = mgr.residentPages(file3ptr);
+	mgr.readPage(file1ptr, 1, page);
+	mgr.unPinPage(file1ptr, 1, false);
+	if (mgr.residentPages(file1ptr) != 1 || mgr.residentPages(file3ptr) != file3Pages)
+	{
+		PRINT_ERROR("ERROR :: Wrong number of resident pages.");
+	}
+	mgr.flushFile(file1ptr);
+	mgr.flushFile(file3ptr);
+	if (mgr.residentPages(file3ptr) != 0)
+	{
+		PRINT_ERROR("ERROR :: Pages of a flushed file are still in the pool.");
+	}
+
+	std::cout << "Test 17 passed" << "\n";
+}
+
+/**
+ *  Test18 scans all of file1 through a ring of four frames after warming up pages of file3.
+ *  The scan must see every page and leave the warm pages in the pool.
+ */
+void test18()
+{
+	BufMgr mgr(20);
+	for (int pass = 0; pass < 2; pass++) {
+		for (PageId j = 1; j <= 10; j++) {
+			mgr.readPage(file3ptr, j, page);
+			mgr.unPinPage(file3ptr, j, false);
+		}
+	}
+
+	BufferRing ring(4);
+	for (PageId j = 1; j <= num; j++) {
+		mgr.readPage(file1ptr, j, page, ring);
+		sprintf((char*)tmpbuf, "test.1 Page %u %7.1f", j, (float)j);
+		RecordId recordId = {j, 1};
+		if(strncmp(page->getRecord(recordId).c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+		{
+			PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+		}
+		mgr.unPinPage(file1ptr, j, false);
+	}
+
+	if (mgr.residentPages(file3ptr) != 10 || mgr.residentPages(file1ptr) > ring.size())
+	{
+		PRINT_ERROR("ERROR :: Scan through a ring pushed other pages out of the pool.");
+	}
+	mgr.flushFile(file1ptr);
+	mgr.flushFile(file3ptr);
+
+	std::cout << "Test 18 passed" << "\n";
+}
+
+/**
+ *  Test19 builds pools backed by each kind of huge page, which must fall back quietly where the
+ *  system has none, and checks that a copy of a page in the pool no longer shares its bytes.
+ */
+void test19()
+{
+	const HugePageMode modes[] = {HugePageMode::NONE, HugePageMode::TRANSPARENT, HugePageMode::EXPLICIT};
+	for (std::size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+		BufMgr mgr(16, ReplacementPolicyType::CLOCK, modes[m]);
+		for (PageId j = 1; j <= 40; j++) {
+			mgr.readPage(file1ptr, j, page);
+			sprintf((char*)tmpbuf, "test.1 Page %u %7.1f", j, (float)j);
+			RecordId recordId = {j, 1};
+			if(strncmp(page->getRecord(recordId).c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+			{
+				PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+			}
+			mgr.unPinPage(file1ptr, j, false);
+		}
+
+		mgr.readPage(file1ptr, 5, page);
+		Page copy = *page;
+		const RecordId added = copy.insertRecord("test.19 copy only");
+		if (page->getFreeSpace() == copy.getFreeSpace() || copy.getRecord(added) != "test.19 copy only")
+		{
+			PRINT_ERROR("ERROR :: Copy of a page shares its bytes with the pool.");
+		}
+		mgr.unPinPage(file1ptr, 5, false);
+		mgr.flushFile(file1ptr);
+	}
+
+	std::cout << "Test 19 passed" << "\n";
+}
+
+/**
+ *  Test20 grows a pool of 8 frames to hold 30 pinned pages, then shrinks it to 4 while a page
+ *  is dirty and another is still pinned by a second thread. The dirty page must reach the file,
+ *  and sizes outside the pool's capacity must be refused.
+ */
+void test20()
+{
+	BufMgr mgr(8, ReplacementPolicyType::CLOCK, HugePageMode::NONE, 64);
+	mgr.resize(32);
+	for (PageId j = 1; j <= 30; j++) {
+		mgr.readPage(file1ptr, j, page);
+		sprintf((char*)tmpbuf, "test.1 Page %u %7.1f", j, (float)j);
+		RecordId recordId = {j, 1};
+		if(strncmp(page->getRecord(recordId).c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+		{
+			PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+		}
+	}
+	mgr.readPage(file1ptr, 30, page);
+	const RecordId added = page->insertRecord("test.20 resized");
+	for (PageId j = 1; j <= 30; j++) {
+		mgr.unPinPage(file1ptr, j, j == 30);
+	}
+	mgr.unPinPage(file1ptr, 30, false);
+
+	mgr.readPage(file1ptr, 29, page);
+	std::thread holder([&mgr]() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		mgr.unPinPage(file1ptr, 29, false);
+	});
+	mgr.resize(4);
+	holder.join();
+	if (mgr.poolSize() != 4 || mgr.residentPages(file1ptr) > 4 || mgr.dirtyFrameCount() > 1)
+	{
+		PRINT_ERROR("ERROR :: Pool did not shrink.");
+	}
+	mgr.flushFile(file1ptr);
+	if (file1ptr->readPage(30).getRecord(added) != "test.20 resized")
+	{
+		PRINT_ERROR("ERROR :: Dirty page was lost by shrinking the pool.");
+	}
+
+	const std::uint32_t badSizes[] = {0, 65};
+	for (std::size_t i = 0; i < 2; i++) {
+		try
+		{
+			mgr.resize(badSizes[i]);
+			PRINT_ERROR("ERROR :: Pool resized beyond its capacity. Exception should have been thrown before execution reached this point.");
+		}
+		catch (const InvalidPoolSizeException& e)
+		{
+		}
+	}
+
+	mgr.resize(64);
+	for (PageId j = 1; j <= 64; j++) {
+		mgr.readPage(file1ptr, j, page);
+	}
+	for (PageId j = 1; j <= 64; j++) {
+		mgr.unPinPage(file1ptr, j, false);
+	}
+	mgr.flushFile(file1ptr);
+
+	std::cout << "Test 20 passed" << "\n";
+}
+
+/**
+ *  Test21 checks the usage statistics of a pool of 5 frames: misses, hits, clean and dirty
+ *  evictions and flush writes, in total and for the file, counted by several threads at once,
+ *  and the text export.
+ */
+void test21()
+{
+	BufMgr mgr(5);
+	const BufStatsSnapshot before = mgr.snapshotBufStats();
+	for (int pass = 0; pass < 2; pass++) {
+		for (PageId j = 1; j <= 5; j++) {
+			mgr.readPage(file1ptr, j, page);
+			mgr.unPinPage(file1ptr, j, pass == 0 && j == 1);
+		}
+	}
+	for (PageId j = 6; j <= 10; j++) {
+		mgr.readPage(file1ptr, j, page);
+		mgr.unPinPage(file1ptr, j, j == 6);
+	}
+	mgr.flushFile(file1ptr);
+	mgr.readPage(file1ptr, 6, page);
+	mgr.unPinPage(file1ptr, 6, false);
+
+	std::vector<std::thread> readers;
+	for (int t = 0; t < 4; t++) {
+		readers.push_back(std::thread([&mgr]() {
+			Page* threadPage;
+			for (int i = 0; i < 100; i++) {
+				mgr.readPage(file1ptr, 6, threadPage);
+				mgr.unPinPage(file1ptr, 6, false);
+			}
+		}));
+	}
+	for (std::size_t t = 0; t < readers.size(); t++) {
+		readers[t].join();
+	}
+
+	const BufStatsSnapshot diff = mgr.snapshotBufStats() - before;
+	const BufStats& total = diff.total;
+	if (total.misses != 11 || total.hits != 405 || total.accesses != total.hits + total.misses ||
+	    total.dirtyEvictions != 1 || total.cleanEvictions != 4 || total.flushWrites != 1 ||
+	    total.diskreads != 11 || total.diskwrites != 2 || total.sweepSteps == 0)
+	{
+		PRINT_ERROR("ERROR :: Wrong buffer pool statistics.");
+	}
+	if (diff.files.size() != 1 || diff.files.begin()->first != file1ptr->filename() ||
+	    diff.files.begin()->second.hits != total.hits || mgr.getBufStats().misses != total.misses)
+	{
+		PRINT_ERROR("ERROR :: Wrong per file statistics.");
+	}
+
+	std::ostringstream text;
+	diff.writeText(text);
+	if (text.str().find("badgerdb_buffer_hits 405\n") == std::string::npos ||
+	    text.str().find("badgerdb_buffer_misses{file=\"test.1\"} 11\n") == std::string::npos)
+	{
+		PRINT_ERROR("ERROR :: Wrong statistics export.");
+	}
+
+	mgr.clearBufStats();
+	if (mgr.getBufStats().accesses != 0)
+	{
+		PRINT_ERROR("ERROR :: Statistics were not cleared.");
+	}
+	mgr.flushFile(file1ptr);
+
+	std::cout << "Test 21 passed" << "\n";
+}
+
+/**
+ *  Test22 dumps the resident pages of one pool, the pinned page first, and reloads the hottest
+ *  of them into a smaller pool in the background. Only pages of the files passed in come back,
+ *  a manifest is also written at shutdown, and files that are not manifests are refused.
+ */
+void test22()
+{
+	{
+		BufMgr mgr(10);
+		mgr.dumpOnShutdown("test.shutdown.manifest");
+		for (PageId j = 1; j <= 8; j++) {
+			mgr.readPage(file1ptr, j, page);
+			mgr.unPinPage(file1ptr, j, false);
+		}
+		for (PageId j = 1; j <= 2; j++) {
+			mgr.readPage(file2ptr, j, page);
+			mgr.unPinPage(file2ptr, j, false);
+		}
+		mgr.readPage(file1ptr, 2, page);
+		if (mgr.dumpResidentPages("test.manifest") != 10)
+		{
+			PRINT_ERROR("ERROR :: Manifest does not list every resident page.");
+		}
+		std::ifstream manifest("test.manifest");
+		std::string line;
+		for (int i = 0; i < 6; i++) {
+			std::getline(manifest, line);
+		}
+		if (line != "0 2")
+		{
+			PRINT_ERROR("ERROR :: Pinned page is not first in the manifest.");
+		}
+		mgr.unPinPage(file1ptr, 2, false);
+	}
+
+	const char* manifests[] = {"test.manifest", "test.shutdown.manifest"};
+	for (int m = 0; m < 2; m++) {
+		BufMgr mgr(6);
+		std::vector<File*> files(1, file1ptr);
+		const std::size_t queued = mgr.loadResidentPages(manifests[m], files);
+		for (int wait = 0; wait < 1000 && mgr.getBufStats().diskreads < queued; wait++) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		if (queued != 6 || mgr.residentPages(file1ptr) != 6 || mgr.residentPages(file2ptr) != 0)
+		{
+			PRINT_ERROR("ERROR :: Manifest was not reloaded.");
+		}
+		// page 2 was pinned when the first manifest was written
+		const BufStats before = mgr.getBufStats();
+		mgr.readPage(file1ptr, 2, page);
+		mgr.unPinPage(file1ptr, 2, false);
+		if (m == 0 && (mgr.getBufStats() - before).hits != 1)
+		{
+			PRINT_ERROR("ERROR :: Hottest page was not reloaded.");
+		}
+		mgr.flushFile(file1ptr);
+	}
+
+	BufMgr mgr(6);
+	const char* notManifests[] = {"test.missing.manifest", "test.1"};
+	for (int m = 0; m < 2; m++) {
+		try
+		{
+			mgr.loadResidentPages(notManifests[m], std::vector<File*>(1, file1ptr));
+			PRINT_ERROR("ERROR :: Bad manifest was loaded. Exception should have been thrown before execution reached this point.");
+		}
+		catch (const InvalidManifestException& e)
+		{
+		}
+	}
+	std::remove("test.manifest");
+	std::remove("test.shutdown.manifest");
+
+	std::cout << "Test 22 passed" << "\n";
+}
+
+/**
+ *  Test23 dirties pages of file1 out of order, in runs and alone, and flushes them, then leaves a
+ *  dirty page pinned when a pool is destroyed. Every page must reach the file and the file's page
+ *  list must be left intact.
+ */
+void test23()
+{
+	std::size_t pagesBefore = 0;
+	for (FileIterator iter = file1ptr->begin(); iter != file1ptr->end(); ++iter) {
+		pagesBefore++;
+	}
+
+	const PageId dirtied[] = {12, 3, 5, 4, 30, 6, 90};
+	const std::size_t numDirtied = sizeof(dirtied) / sizeof(dirtied[0]);
+	RecordId added[numDirtied];
+	BufMgr mgr(20);
+	for (std::size_t i = 0; i < numDirtied; i++) {
+		mgr.readPage(file1ptr, dirtied[i], page);
+		sprintf((char*)tmpbuf, "test.23 Page %u", dirtied[i]);
+		added[i] = page->insertRecord(tmpbuf);
+		mgr.unPinPage(file1ptr, dirtied[i], true);
+	}
+	const BufStats before = mgr.getBufStats();
+	mgr.flushFile(file1ptr);
+	const BufStats flushed = mgr.getBufStats() - before;
+	if (flushed.flushWrites != numDirtied || flushed.diskwrites != numDirtied ||
+	    mgr.dirtyFrameCount() != 0 || mgr.residentPages(file1ptr) != 0)
+	{
+		PRINT_ERROR("ERROR :: Dirty pages were not flushed.");
+	}
+	for (std::size_t i = 0; i < numDirtied; i++) {
+		sprintf((char*)tmpbuf, "test.23 Page %u", dirtied[i]);
+		if (file1ptr->readPage(dirtied[i]).getRecord(added[i]) != tmpbuf)
+		{
+			PRINT_ERROR("ERROR :: Flushed page does not match the buffer.");
+		}
+	}
+
+	RecordId pinnedRecord;
+	{
+		BufMgr shuttingDown(5);
+		shuttingDown.readPage(file1ptr, 40, page);
+		pinnedRecord = page->insertRecord("test.23 pinned at shutdown");
+		shuttingDown.unPinPage(file1ptr, 40, true);
+		shuttingDown.readPage(file1ptr, 40, page);
+	}
+	if (file1ptr->readPage(40).getRecord(pinnedRecord) != "test.23 pinned at shutdown")
+	{
+		PRINT_ERROR("ERROR :: Dirty page was not written at shutdown.");
+	}
+
+	std::size_t pagesAfter = 0;
+	for (FileIterator iter = file1ptr->begin(); iter != file1ptr->end(); ++iter) {
+		pagesAfter++;
+	}
+	if (pagesAfter != pagesBefore)
+	{
+		PRINT_ERROR("ERROR :: Flushing broke the file's page list.");
+	}
+
+	std::cout << "Test 23 passed" << "\n";
+}
+
+/**
+ *  Test24 gives a pool of 5 frames a compressed tier and checks that pages evicted from the pool
+ *  come back from the tier, one at a time and in batches, including a page that was dirty when
+ *  evicted. A flush empties the tier, and a tier too small for every page keeps only some.
+ */
+void test24()
+{
+	BufMgr mgr(5);
+	mgr.enableCompressedTier(1 << 20);
+	for (PageId j = 1; j <= 10; j++) {
+		mgr.readPage(file1ptr, j, page);
+		mgr.unPinPage(file1ptr, j, false);
+	}
+	if (mgr.compressedPages() != 5)
+	{
+		PRINT_ERROR("ERROR :: Evicted pages were not kept in the compressed tier.");
+	}
+
+	BufStats before = mgr.getBufStats();
+	for (PageId j = 1; j <= 5; j++) {
+		mgr.readPage(file1ptr, j, page);
+		sprintf((char*)tmpbuf, "test.1 Page %u %7.1f", j, (float)j);
+		RecordId recordId = {j, 1};
+		if(strncmp(page->getRecord(recordId).c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+		{
+			PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+		}
+		mgr.unPinPage(file1ptr, j, false);
+	}
+	BufStats served = mgr.getBufStats() - before;
+	if (served.compressedHits != 5 || served.diskreads != 0)
+	{
+		PRINT_ERROR("ERROR :: Misses were not served from the compressed tier.");
+	}
+
+	mgr.readPage(file1ptr, 6, page);
+	const RecordId added = page->insertRecord("test.24 compressed");
+	mgr.unPinPage(file1ptr, 6, true);
+	for (PageId j = 1; j <= 5; j++) {
+		mgr.readPage(file1ptr, j, page);
+		mgr.unPinPage(file1ptr, j, false);
+	}
+	mgr.readPage(file1ptr, 6, page);
+	if (page->getRecord(added) != "test.24 compressed")
+	{
+		PRINT_ERROR("ERROR :: Page dirtied before eviction came back without its change.");
+	}
+	mgr.unPinPage(file1ptr, 6, false);
+
+	const PageKey batch[] = {{file1ptr, 7}, {file1ptr, 8}, {file1ptr, 9}};
+	Page* batchPages[3];
+	before = mgr.getBufStats();
+	mgr.readPages(batch, 3, batchPages);
+	mgr.unPinPages(batch, 3, false);
+	served = mgr.getBufStats() - before;
+	if (served.compressedHits != 3 || served.diskreads != 0)
+	{
+		PRINT_ERROR("ERROR :: Batched misses were not served from the compressed tier.");
+	}
+
+	mgr.flushFile(file1ptr);
+	if (mgr.compressedPages() != 0)
+	{
+		PRINT_ERROR("ERROR :: Flushed file still has pages in the compressed tier.");
+	}
+
+	BufMgr small(2);
+	small.enableCompressedTier(400);
+	for (PageId j = 1; j <= 10; j++) {
+		small.readPage(file1ptr, j, page);
+		small.unPinPage(file1ptr, j, false);
+	}
+	if (small.compressedPages() == 0 || small.compressedPages() >= 8)
+	{
+		PRINT_ERROR("ERROR :: Compressed tier outgrew its capacity.");
+	}
+	small.flushFile(file1ptr);
+
+	std::cout << "Test 24 passed" << "\n";
+}
+
+/**
+ *  Test25 gives a pool of 5 frames a secondary cache file and checks that pages evicted from the
+ *  pool come back from it, that a new pool on the same cache file still finds them, and that a
+ *  page dirty when evicted comes back with its change. Invalidating the file empties the cache.
+ */
+void test25()
+{
+	std::remove("test.cache");
+	{
+		BufMgr mgr(5);
+		mgr.enableSecondaryCache("test.cache", 64);
+		for (PageId j = 1; j <= 10; j++) {
+			mgr.readPage(file1ptr, j, page);
+			mgr.unPinPage(file1ptr, j, false);
+		}
+		if (mgr.secondaryPages() != 5)
+		{
+			PRINT_ERROR("ERROR :: Evicted pages were not kept in the secondary cache.");
+		}
+
+		BufStats before = mgr.getBufStats();
+		for (PageId j = 1; j <= 5; j++) {
+			mgr.readPage(file1ptr, j, page);
+			sprintf((char*)tmpbuf, "test.1 Page %u %7.1f", j, (float)j);
+			RecordId recordId = {j, 1};
+			if(strncmp(page->getRecord(recordId).c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+			{
+				PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+			}
+			mgr.unPinPage(file1ptr, j, false);
+		}
+		BufStats served = mgr.getBufStats() - before;
+		if (served.secondaryHits != 5 || served.diskreads != 0)
+		{
+			PRINT_ERROR("ERROR :: Misses were not served from the secondary cache.");
+		}
+	}
+
+	// pages 6 to 10 were evicted by the reads above and are still in the cache file
+	BufMgr mgr(5);
+	mgr.enableSecondaryCache("test.cache", 64);
+	if (mgr.secondaryPages() != 5)
+	{
+		PRINT_ERROR("ERROR :: Reopened secondary cache lost its pages.");
+	}
+	BufStats before = mgr.getBufStats();
+	for (PageId j = 6; j <= 10; j++) {
+		mgr.readPage(file1ptr, j, page);
+		sprintf((char*)tmpbuf, "test.1 Page %u %7.1f", j, (float)j);
+		RecordId recordId = {j, 1};
+		if(strncmp(page->getRecord(recordId).c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+		{
+			PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+		}
+		mgr.unPinPage(file1ptr, j, false);
+	}
+	BufStats served = mgr.getBufStats() - before;
+	if (served.secondaryHits != 5 || served.diskreads != 0)
+	{
+		PRINT_ERROR("ERROR :: Reopened secondary cache did not serve its pages.");
+	}
+
+	mgr.readPage(file1ptr, 6, page);
+	const RecordId added = page->insertRecord("test.25 secondary");
+	mgr.unPinPage(file1ptr, 6, true);
+	for (PageId j = 11; j <= 15; j++) {
+		mgr.readPage(file1ptr, j, page);
+		mgr.unPinPage(file1ptr, j, false);
+	}
+	before = mgr.getBufStats();
+	mgr.readPage(file1ptr, 6, page);
+	if (page->getRecord(added) != "test.25 secondary")
+	{
+		PRINT_ERROR("ERROR :: Page dirtied before eviction came back without its change.");
+	}
+	mgr.unPinPage(file1ptr, 6, false);
+	if ((mgr.getBufStats() - before).secondaryHits != 1)
+	{
+		PRINT_ERROR("ERROR :: Dirty page was not served from the secondary cache.");
+	}
+
+	mgr.invalidateFile(file1ptr);
+	if (mgr.secondaryPages() != 0)
+	{
+		PRINT_ERROR("ERROR :: Invalidated file still has pages in the secondary cache.");
+	}
+
+	bool thrown = false;
+	try
+	{
+		BufMgr bad(5);
+		bad.enableSecondaryCache("no.such.directory/test.cache", 8);
+	}
+	catch(SecondaryCacheException &e)
+	{
+		thrown = true;
+	}
+	if (!thrown)
+	{
+		PRINT_ERROR("ERROR :: Unusable cache file was not reported.");
+	}
+
+	std::remove("test.cache");
+	std::cout << "Test 25 passed" << "\n";
+}
+
+/**
+ *  Test26 reads a page without pinning it and checks that validate() accepts the reads until
+ *  the page is pinned, changed or evicted, and that a pinned or evicted page is not found. A page
+ *  is also found through a reference, and no optimistic read is counted.
+ */
+void test26()
+{
+	BufMgr mgr(5);
+	mgr.readPage(file1ptr, 1, page);
+	mgr.unPinPage(file1ptr, 1, false);
+
+	OptimisticPage handle;
+	if (!mgr.readPageOptimistic(file1ptr, 1, handle))
+	{
+		PRINT_ERROR("ERROR :: Resident page was not found optimistically.");
+	}
+	sprintf((char*)tmpbuf, "test.1 Page %u %7.1f", 1, 1.0f);
+	RecordId recordId = {1, 1};
+	std::string record = handle.page->getRecord(recordId);
+	if (!mgr.validate(handle) || strncmp(record.c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+	{
+		PRINT_ERROR("ERROR :: Optimistic read of an untouched page did not validate.");
+	}
+	if (!mgr.validate(handle))
+	{
+		PRINT_ERROR("ERROR :: Handle did not stay valid while the page was untouched.");
+	}
+
+	// a pin, even one that changes nothing, ends the reads
+	mgr.readPage(file1ptr, 1, page);
+	OptimisticPage pinned;
+	if (mgr.validate(handle) || mgr.readPageOptimistic(file1ptr, 1, pinned))
+	{
+		PRINT_ERROR("ERROR :: Pinned page was read optimistically.");
+	}
+	mgr.unPinPage(file1ptr, 1, false);
+	if (mgr.validate(handle))
+	{
+		PRINT_ERROR("ERROR :: Handle survived a pin.");
+	}
+
+	mgr.readPageOptimistic(file1ptr, 1, handle);
+	mgr.readPage(file1ptr, 1, page);
+	const RecordId added = page->insertRecord("test.26 optimistic");
+	mgr.unPinPage(file1ptr, 1, true);
+	if (mgr.validate(handle))
+	{
+		PRINT_ERROR("ERROR :: Handle survived a change to the page.");
+	}
+	if (!mgr.readPageOptimistic(file1ptr, 1, handle))
+	{
+		PRINT_ERROR("ERROR :: Changed page was not found optimistically.");
+	}
+	record = handle.page->getRecord(added);
+	if (!mgr.validate(handle) || record != "test.26 optimistic")
+	{
+		PRINT_ERROR("ERROR :: Optimistic read missed the change.");
+	}
+
+	for (PageId j = 2; j <= 6; j++) {
+		mgr.readPage(file1ptr, j, page);
+		mgr.unPinPage(file1ptr, j, false);
+	}
+	if (mgr.validate(handle) || mgr.readPageOptimistic(file1ptr, 1, handle))
+	{
+		PRINT_ERROR("ERROR :: Evicted page was read optimistically.");
+	}
+
+	// a reference finds its frame with no lookup, and no optimistic read is counted anywhere
+	PageRef ref(file1ptr, 2);
+	mgr.readPage(ref, page);
+	mgr.unPinPage(ref, false);
+	BufStats before = mgr.getBufStats();
+	if (!mgr.readPageOptimistic(ref, handle) || handle.page != page || !mgr.validate(handle))
+	{
+		PRINT_ERROR("ERROR :: Page was not found optimistically through its reference.");
+	}
+	if (!mgr.readPageOptimistic(file1ptr, 2, pinned) || pinned.frame != handle.frame ||
+		  (mgr.getBufStats() - before).accesses != 0)
+	{
+		PRINT_ERROR("ERROR :: Optimistic read was counted as an access.");
+	}
+	mgr.flushFile(file1ptr);
+
+	std::cout << "Test 26 passed" << "\n";
+}
+
+/**
+ *  Test27 follows page references that swizzle to frames. A swizzled reference finds its page
+ *  without a miss, one whose page was evicted still finds it, and several threads sharing
+ *  references into a pool too small for every page always get the right page.
+ */
+void test27()
+{
+	BufMgr mgr(5);
+	PageRef ref(file1ptr, 2);
+	if (ref.swizzled())
+	{
+		PRINT_ERROR("ERROR :: New reference was swizzled.");
+	}
+	mgr.readPage(ref, page);
+	mgr.unPinPage(ref, false);
+	if (!ref.swizzled())
+	{
+		PRINT_ERROR("ERROR :: Followed reference was not swizzled.");
+	}
+
+	BufStats before = mgr.getBufStats();
+	mgr.readPage(ref, page);
+	sprintf((char*)tmpbuf, "test.1 Page %u %7.1f", 2, 2.0f);
+	RecordId recordId = {2, 1};
+	if(strncmp(page->getRecord(recordId).c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+	{
+		PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+	}
+	mgr.unPinPage(ref, false);
+	BufStats served = mgr.getBufStats() - before;
+	if (served.hits != 1 || served.misses != 0)
+	{
+		PRINT_ERROR("ERROR :: Swizzled reference did not hit.");
+	}
+
+	bool thrown = false;
+	try
+	{
+		mgr.unPinPage(ref, false);
+	}
+	catch(PageNotPinnedException &e)
+	{
+		thrown = true;
+	}
+	if (!thrown)
+	{
+		PRINT_ERROR("ERROR :: Unpinning an unpinned page through a reference was not reported.");
+	}
+
+	for (PageId j = 3; j <= 8; j++) {
+		mgr.readPage(file1ptr, j, page);
+		mgr.unPinPage(file1ptr, j, false);
+	}
+	mgr.readPage(ref, page);
+	if(strncmp(page->getRecord(recordId).c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+	{
+		PRINT_ERROR("ERROR :: Reference to an evicted page found the wrong page.");
+	}
+	mgr.unPinPage(ref, false);
+
+	std::vector<PageRef> refs;
+	for (PageId j = 1; j <= 10; j++) {
+		refs.push_back(PageRef(file1ptr, j));
+	}
+	std::atomic<bool> mismatch(false);
+	std::vector<std::thread> workers;
+	for (int t = 0; t < 4; t++) {
+		workers.push_back(std::thread([t, &mgr, &refs, &mismatch]() {
+			unsigned int seed = t;
+			char expected[100];
+			Page* threadPage;
+			for (int j = 0; j < 2000; j++) {
+				PageRef& threadRef = refs[rand_r(&seed) % refs.size()];
+				mgr.readPage(threadRef, threadPage);
+				sprintf(expected, "test.1 Page %u %7.1f", threadRef.pageNo, (float)threadRef.pageNo);
+				RecordId threadRecord = {threadRef.pageNo, 1};
+				if(strncmp(threadPage->getRecord(threadRecord).c_str(), expected, strlen(expected)) != 0)
+				{
+					mismatch = true;
+				}
+				mgr.unPinPage(threadRef, false);
+			}
+		}));
+	}
+	for (std::size_t t = 0; t < workers.size(); t++)
+		workers[t].join();
+	if (mismatch)
+	{
+		PRINT_ERROR("ERROR :: Shared reference found the wrong page.");
+	}
+	mgr.flushFile(file1ptr);
+
+	std::cout << "Test 27 passed" << "\n";
+}
+
+/**
+ *  Test28 checks the status-returning calls: filling a page until tryInsertRecord reports it full,
+ *  reading a page the file does not have, and reading or allocating with every frame pinned,
+ *  which must leave the file as it was.
+ */
+void test28()
+{
+	Page loose;
+	RecordId recordId;
+	std::size_t inserted = 0;
+	while (loose.tryInsertRecord("test.28 status record", recordId) == Status::OK) {
+		inserted++;
+	}
+	if (inserted == 0 || loose.hasSpaceForRecord("test.28 status record"))
+	{
+		PRINT_ERROR("ERROR :: tryInsertRecord stopped before the page was full.");
+	}
+
+	Page filePage;
+	if (file1ptr->tryReadPage(100000, filePage) != Status::INVALID_PAGE ||
+		file1ptr->tryReadPage(1, filePage) != Status::OK)
+	{
+		PRINT_ERROR("ERROR :: File::tryReadPage reported the wrong status.");
+	}
+
+	BufMgr mgr(2);
+	if (mgr.tryReadPage(file1ptr, 100000, page) != Status::INVALID_PAGE)
+	{
+		PRINT_ERROR("ERROR :: Missing page was not reported by tryReadPage.");
+	}
+	Page* first;
+	Page* second;
+	if (mgr.tryReadPage(file1ptr, 1, first) != Status::OK || mgr.tryReadPage(file1ptr, 2, second) != Status::OK)
+	{
+		PRINT_ERROR("ERROR :: tryReadPage failed on a pool with free frames.");
+	}
+
+	std::size_t pagesBefore = 0;
+	for (FileIterator iter = file1ptr->begin(); iter != file1ptr->end(); ++iter) {
+		pagesBefore++;
+	}
+	PageId pageNo;
+	if (mgr.tryReadPage(file1ptr, 3, page) != Status::BUFFER_EXCEEDED ||
+		mgr.tryAllocPage(file1ptr, pageNo, page) != Status::BUFFER_EXCEEDED)
+	{
+		PRINT_ERROR("ERROR :: Full pool was not reported.");
+	}
+	std::size_t pagesAfter = 0;
+	for (FileIterator iter = file1ptr->begin(); iter != file1ptr->end(); ++iter) {
+		pagesAfter++;
+	}
+	if (pagesAfter != pagesBefore)
+	{
+		PRINT_ERROR("ERROR :: Allocating with a full pool changed the file.");
+	}
+
+	mgr.unPinPage(file1ptr, 1, false);
+	mgr.unPinPage(file1ptr, 2, false);
+	if (mgr.tryReadPage(file1ptr, 3, page) != Status::OK)
+	{
+		PRINT_ERROR("ERROR :: tryReadPage failed once frames were free.");
+	}
+	mgr.unPinPage(file1ptr, 3, false);
+	mgr.flushFile(file1ptr);
+
+	std::cout << "Test 28 passed" << "\n";
+}
+
+/**
+ *  Test29 checks that File objects open on the same file share its pages in the pool: a page read
+ *  through one is found through a copy or a second open of the file, in the same frame.
+ */
+void test29()
+{
+	File copy = *file1ptr;
+	File reopened = File::open(file1ptr->filename());
+	if (copy.id() != file1ptr->id() || reopened.id() != file1ptr->id() || file2ptr->id() == file1ptr->id())
+	{
+		PRINT_ERROR("ERROR :: Files were given the wrong IDs.");
+	}
+
+	BufMgr mgr(4);
+	Page* first;
+	Page* second;
+	mgr.readPage(file1ptr, 1, first);
+	mgr.readPage(&reopened, 1, second);
+	if (first != second || mgr.residentPages(file1ptr) != 1 || mgr.residentPages(&copy) != 1)
+	{
+		PRINT_ERROR("ERROR :: Page read through two File objects was loaded twice.");
+	}
+
+	// both pins are on the one frame, so either object can drop either
+	mgr.unPinPage(&copy, 1, false);
+	mgr.unPinPage(file1ptr, 1, false);
+	try
+	{
+		mgr.unPinPage(&reopened, 1, false);
+		PRINT_ERROR("ERROR :: No such exception. Page was unpinned more often than it was read.");
+	}
+	catch(const PageNotPinnedException &e)
+	{
+	}
+	mgr.flushFile(&copy);
+	if (mgr.residentPages(file1ptr) != 0)
+	{
+		PRINT_ERROR("ERROR :: Flushing through a copy left the file's pages in the pool.");
+	}
+
+	// a page outlives the File object it was loaded through: it is written back by a flush through
+	// another object, and by eviction once no object is open on the file at all
+	const std::string filename = "test.29";
+	if (File::exists(filename))
+	{
+		File::remove(filename);
+	}
+	PageId flushed, evicted;
+	RecordId flushedRid, evictedRid;
+	{
+		File owner = File::create(filename);
+		{
+			File loader = File::open(filename);
+			mgr.allocPage(&loader, flushed, page);
+			flushedRid = page->insertRecord("test.29 flushed");
+			mgr.unPinPage(&loader, flushed, true);
+		}
+		mgr.flushFile(&owner);
+		{
+			File loader = File::open(filename);
+			mgr.allocPage(&loader, evicted, page);
+			evictedRid = page->insertRecord("test.29 evicted");
+			mgr.unPinPage(&loader, evicted, true);
+		}
+	}
+	for (PageId j = 1; j <= 8; j++) {
+		mgr.readPage(file1ptr, j, page);
+		mgr.unPinPage(file1ptr, j, false);
+	}
+	{
+		File written = File::open(filename);
+		if (written.readPage(flushed).getRecord(flushedRid) != "test.29 flushed" ||
+			  written.readPage(evicted).getRecord(evictedRid) != "test.29 evicted")
+		{
+			PRINT_ERROR("ERROR :: Page was not written back after its File object was destroyed.");
+		}
+	}
+	File::remove(filename);
+
+	std::cout << "Test 29 passed" << "\n";
+}
+
+/**
+ *  Test30 pins and unpins one hot page from several threads while they churn a small pool with
+ *  other pages, some of them dirtying the hot page. Every pin must be given back, the page must
+ *  be counted dirty once, and no other page may be evicted from under its reader.
+ */
+void test30()
+{
+	BufMgr mgr(6);
+	Page* hot;
+	// a pin held throughout, so the threads' pins of the hot page never take it to or from zero
+	mgr.readPage(file1ptr, 1, hot);
+
+	std::atomic<bool> mismatch(false);
+	std::vector<std::thread> workers;
+	for (int t = 0; t < 4; t++) {
+		workers.push_back(std::thread([t, &mgr, &mismatch]() {
+			unsigned int seed = t;
+			char expected[100];
+			Page* threadPage;
+			for (int j = 0; j < 2000; j++) {
+				mgr.readPage(file1ptr, 1, threadPage);
+				mgr.unPinPage(file1ptr, 1, j % 100 == 0);
+
+				const PageId other = 2 + rand_r(&seed) % 8;
+				mgr.readPage(file1ptr, other, threadPage);
+				sprintf(expected, "test.1 Page %u %7.1f", other, (float)other);
+				RecordId threadRecord = {other, 1};
+				if(strncmp(threadPage->getRecord(threadRecord).c_str(), expected, strlen(expected)) != 0)
+				{
+					mismatch = true;
+				}
+				mgr.unPinPage(file1ptr, other, false);
+			}
+		}));
+	}
+	for (std::size_t t = 0; t < workers.size(); t++)
+		workers[t].join();
+	if (mismatch)
+	{
+		PRINT_ERROR("ERROR :: Page changed under a thread that had it pinned.");
+	}
+	if (mgr.dirtyFrameCount() != 1)
+	{
+		PRINT_ERROR("ERROR :: Hot page dirtied by many threads was not counted dirty once.");
+	}
+
+	// only the pin taken above is left
+	mgr.unPinPage(file1ptr, 1, false);
+	try
+	{
+		mgr.unPinPage(file1ptr, 1, false);
+		PRINT_ERROR("ERROR :: No such exception. Hot page was left pinned.");
+	}
+	catch(const PageNotPinnedException &e)
+	{
+	}
+	mgr.flushFile(file1ptr);
+	if (mgr.dirtyFrameCount() != 0 || mgr.residentPages(file1ptr) != 0)
+	{
+		PRINT_ERROR("ERROR :: Hot page was not written back and dropped.");
+	}
+
+	std::cout << "Test 30 passed" << "\n";
+}
+
+/**
+ *  Test31 checks where frames for misses come from. Frames emptied by flushFile() in a mostly
+ *  pinned pool are handed out without the clock hand moving, and with a victim batch one search
+ *  claims frames for the misses after it, which then need no search at all.
+ */
+void test31()
+{
+	BufMgr mgr(50);
+	for (PageId j = 1; j <= 40; j++) {
+		mgr.readPage(file1ptr, j, page);
+	}
+	for (PageId j = 1; j <= 10; j++) {
+		mgr.readPage(file3ptr, j, page);
+		mgr.unPinPage(file3ptr, j, false);
+	}
+	mgr.flushFile(file3ptr);
+
+	BufStats before = mgr.getBufStats();
+	for (PageId j = 1; j <= 10; j++) {
+		mgr.readPage(file3ptr, j, page);
+	}
+	if ((mgr.getBufStats() - before).sweepSteps != 0)
+	{
+		PRINT_ERROR("ERROR :: Frames emptied by flushFile were not taken from the free list.");
+	}
+	for (PageId j = 1; j <= 10; j++) {
+		mgr.unPinPage(file3ptr, j, false);
+	}
+	for (PageId j = 1; j <= 40; j++) {
+		mgr.unPinPage(file1ptr, j, false);
+	}
+	mgr.flushFile(file1ptr);
+	mgr.flushFile(file3ptr);
+
+	BufMgr batched(5);
+	batched.setVictimBatch(4);
+	for (PageId j = 1; j <= 5; j++) {
+		batched.readPage(file1ptr, j, page);
+		batched.unPinPage(file1ptr, j, false);
+	}
+	// a full pool: the miss claims four victims and keeps three
+	batched.readPage(file1ptr, 6, page);
+	batched.unPinPage(file1ptr, 6, false);
+	if (batched.reservedFrames() != 3 || batched.residentPages(file1ptr) != 2)
+	{
+		PRINT_ERROR("ERROR :: Miss did not claim a batch of victims.");
+	}
+	before = batched.getBufStats();
+	for (PageId j = 7; j <= 9; j++) {
+		batched.readPage(file1ptr, j, page);
+		batched.unPinPage(file1ptr, j, false);
+	}
+	if ((batched.getBufStats() - before).sweepSteps != 0 || batched.reservedFrames() != 0 ||
+		batched.residentPages(file1ptr) != 5)
+	{
+		PRINT_ERROR("ERROR :: Misses did not take the reserved frames.");
+	}
+
+	// reserved frames at the top of the pool are given up when it shrinks
+	batched.readPage(file1ptr, 10, page);
+	batched.unPinPage(file1ptr, 10, false);
+	batched.resize(2);
+	batched.setVictimBatch(1);
+	if (batched.reservedFrames() != 0 || batched.residentPages(file1ptr) > 2)
+	{
+		PRINT_ERROR("ERROR :: Shrinking the pool kept reserved frames.");
+	}
+	batched.readPage(file1ptr, 11, page);
+	batched.unPinPage(file1ptr, 11, false);
+	batched.flushFile(file1ptr);
+
+	std::cout << "Test 31 passed" << "\n";
+}
+
+/**
+ *  Reads pages first to last of file1 through readPageAsync(), counting the ones with the right
+ *  record and the ones the coroutine was not resumed on the thread driving the loop for
+ */
+Task<int> readRangeAsync(BufMgr& mgr, const PageId first, const PageId last, std::thread::id driver,
+                         int& strayResumes)
+{
+	int matched = 0;
+	char expected[100];
+	for (PageId j = first; j <= last; j++) {
+		Page* asyncPage = co_await mgr.readPageAsync(file1ptr, j);
+		if (std::this_thread::get_id() != driver)
+			strayResumes++;
+		sprintf(expected, "test.1 Page %u %7.1f", j, (float)j);
+		RecordId recordId = {j, 1};
+		if (strncmp(asyncPage->getRecord(recordId).c_str(), expected, strlen(expected)) == 0)
+			matched++;
+		mgr.unPinPage(file1ptr, j, false);
+	}
+	co_return matched;
+}
+
+/**
+ *  Allocates a page of file2 through allocPageAsync(), writes a record on it and flushes the file
+ *  through flushFileAsync()
+ */
+Task<PageId> allocAndFlushAsync(BufMgr& mgr)
+{
+	PageId newPage;
+	Page* asyncPage = co_await mgr.allocPageAsync(file2ptr, newPage);
+	asyncPage->insertRecord("test.32 async record");
+	mgr.unPinPage(file2ptr, newPage, true);
+	co_await mgr.flushFileAsync(file2ptr);
+	co_return newPage;
+}
+
+/**
+ *  Tries to read a page file1 does not have through readPageAsync()
+ */
+Task<bool> readMissingAsync(BufMgr& mgr)
+{
+	try
+	{
+		co_await mgr.readPageAsync(file1ptr, 100000);
+	}
+	catch(const InvalidPageException &e)
+	{
+		co_return true;
+	}
+	co_return false;
+}
+
+/**
+ *  Test32 runs page accesses as coroutines on an event loop with two I/O threads. Two readers
+ *  interleave on the one thread that drives the loop, a hit completes without suspending, a page
+ *  is allocated and flushed, and a missing page is reported through co_await.
+ */
+void test32()
+{
+	BufMgr mgr(10);
+	IoEventLoop loop(2);
+	mgr.setEventLoop(&loop);
+
+	int strayResumes = 0;
+	Task<int> low = readRangeAsync(mgr, 1, 8, std::this_thread::get_id(), strayResumes);
+	Task<int> high = readRangeAsync(mgr, 11, 18, std::this_thread::get_id(), strayResumes);
+	low.start();
+	high.start();
+	// both suspended on their first miss, so neither blocked the thread that started them
+	if (low.done() || high.done())
+	{
+		PRINT_ERROR("ERROR :: Coroutine did not suspend on a miss.");
+	}
+	while (!low.done() || !high.done()) {
+		loop.runOnce();
+	}
+	if (low.result() != 8 || high.result() != 8 || strayResumes != 0)
+	{
+		PRINT_ERROR("ERROR :: Coroutines read the wrong pages or were resumed off the loop.");
+	}
+
+	// page 8 is still in the pool, so the read finishes before start() returns
+	Task<Page*> hit = mgr.readPageAsync(file1ptr, 8);
+	hit.start();
+	if (!hit.done())
+	{
+		PRINT_ERROR("ERROR :: Coroutine suspended on a hit.");
+	}
+	mgr.unPinPage(file1ptr, 8, false);
+
+	const PageId newPage = loop.run(allocAndFlushAsync(mgr));
+	if (mgr.residentPages(file2ptr) != 0 ||
+		file2ptr->readPage(newPage).getRecord({newPage, 1}) != "test.32 async record")
+	{
+		PRINT_ERROR("ERROR :: Page allocated and flushed through the loop was not written.");
+	}
+	if (!loop.run(readMissingAsync(mgr)))
+	{
+		PRINT_ERROR("ERROR :: Missing page was not reported through co_await.");
+	}
+	mgr.flushFile(file1ptr);
+
+	std::cout << "Test 32 passed" << "\n";
+}
+
+/**
+ *  Reads pages from to to of file and unpins each at once, as a scan would
+ */
+void scanPages(BufMgr& mgr, File* file, const PageId from, const PageId to)
+{
+	for (PageId j = from; j <= to; j++) {
+		mgr.readPage(file, j, page);
+		mgr.unPinPage(file, j, false);
+	}
+}
+
+/**
+ *  True if reading page j of file1 again did not miss
+ */
+bool stillResident(BufMgr& mgr, const PageId j)
+{
+	BufStats before = mgr.getBufStats();
+	mgr.readPage(file1ptr, j, page);
+	mgr.unPinPage(file1ptr, j, false);
+	return (mgr.getBufStats() - before).misses == 0;
+}
+
+/**
+ *  Test33 gives pages of a pool of 3 frames priorities. A sticky page outlives a scan while its
+ *  pin count stays zero, a high priority page outlives a short scan but not a long one, a page
+ *  lowered to normal is evicted again, and a pool of sticky pages is full.
+ */
+void test33()
+{
+	BufMgr mgr(3);
+	mgr.readPage(file1ptr, 1, page, PagePriority::STICKY);
+	mgr.unPinPage(file1ptr, 1, false);
+	scanPages(mgr, file1ptr, 2, 20);
+	if (!stillResident(mgr, 1))
+	{
+		PRINT_ERROR("ERROR :: Sticky page was evicted by a scan.");
+	}
+
+	// a high priority page is passed over a few times, then evicted like any other
+	mgr.setPriority(file1ptr, 1, PagePriority::HIGH);
+	scanPages(mgr, file1ptr, 2, 3);
+	if (!stillResident(mgr, 1))
+	{
+		PRINT_ERROR("ERROR :: High priority page was evicted by a short scan.");
+	}
+	scanPages(mgr, file1ptr, 2, 20);
+	if (stillResident(mgr, 1))
+	{
+		PRINT_ERROR("ERROR :: High priority page was never evicted.");
+	}
+
+	mgr.setPriority(file1ptr, 1, PagePriority::STICKY);
+	mgr.setPriority(file1ptr, 1, PagePriority::NORMAL);
+	scanPages(mgr, file1ptr, 2, 20);
+	if (stillResident(mgr, 1))
+	{
+		PRINT_ERROR("ERROR :: Page lowered to normal priority was never evicted.");
+	}
+
+	// sticky pages are still dropped by flushFile, since none of them is pinned
+	mgr.flushFile(file1ptr);
+	if (mgr.setPriority(file1ptr, 1, PagePriority::HIGH))
+	{
+		PRINT_ERROR("ERROR :: Priority was given to a page that is not resident.");
+	}
+	for (PageId j = 1; j <= 3; j++) {
+		mgr.readPage(file1ptr, j, page, PagePriority::STICKY);
+		mgr.unPinPage(file1ptr, j, false);
+	}
+	try
+	{
+		mgr.readPage(file1ptr, 4, page);
+		PRINT_ERROR("ERROR :: No error thrown for a pool of sticky pages.");
+	}
+	catch(const BufferExceededException &e)
+	{
+	}
+	mgr.flushFile(file1ptr);
+	if (mgr.residentPages(file1ptr) != 0)
+	{
+		PRINT_ERROR("ERROR :: Sticky pages were kept by flushFile.");
+	}
+	scanPages(mgr, file1ptr, 1, 6);
+	mgr.flushFile(file1ptr);
+
+	std::cout << "Test 33 passed" << "\n";
+}
+
+/**
+ *  Test34 shares a pool of 10 frames between file1, with a quota of its own, and a group made of
+ *  file2 and file3 with a reservation. A file at its quota evicts its own pages, a scan passes
+ *  over reserved pages, and a file over a lowered quota gives up pages first.
+ */
+void test34()
+{
+	BufMgr mgr(10);
+	mgr.setQuota(file1ptr, 0, 4);
+	scanPages(mgr, file1ptr, 1, 30);
+	if (mgr.residentPages(file1ptr) != 4 || mgr.groupFrames(file1ptr->filename()) != 4)
+	{
+		PRINT_ERROR("ERROR :: File went past its quota.");
+	}
+
+	// with every page of the file pinned, the quota is not exceeded even though frames are free
+	for (PageId j = 1; j <= 4; j++) {
+		mgr.readPage(file1ptr, j, page);
+	}
+	try
+	{
+		mgr.readPage(file1ptr, 5, page);
+		PRINT_ERROR("ERROR :: No error thrown for a file at its quota with every page pinned.");
+	}
+	catch(const BufferExceededException &e)
+	{
+	}
+	for (PageId j = 1; j <= 4; j++) {
+		mgr.unPinPage(file1ptr, j, false);
+	}
+
+	mgr.setFileGroup(file2ptr, "tenant");
+	mgr.setFileGroup(file3ptr, "tenant");
+	mgr.setQuota("tenant", 3, 10);
+	scanPages(mgr, file2ptr, 1, 3);
+	mgr.setQuota(file1ptr, 0, 10);
+	scanPages(mgr, file1ptr, 1, 30);
+	if (mgr.residentPages(file2ptr) != 3 || mgr.residentPages(file1ptr) != 7)
+	{
+		PRINT_ERROR("ERROR :: Scan evicted pages of a group within its reservation.");
+	}
+
+	// file1 is now over its quota, so the group's misses take its frames rather than the group's
+	mgr.setQuota(file1ptr, 0, 2);
+	scanPages(mgr, file3ptr, 1, 5);
+	if (mgr.residentPages(file1ptr) != 2 || mgr.groupFrames("tenant") != 8)
+	{
+		PRINT_ERROR("ERROR :: File over its quota did not give up frames first.");
+	}
+
+	try
+	{
+		mgr.setQuota("tenant", 5, 4);
+		PRINT_ERROR("ERROR :: No error thrown for a reservation above the quota.");
+	}
+	catch(const InvalidQuotaException &e)
+	{
+	}
+	mgr.flushFile(file1ptr);
+	mgr.flushFile(file2ptr);
+	mgr.flushFile(file3ptr);
+	if (mgr.groupFrames("tenant") != 0)
+	{
+		PRINT_ERROR("ERROR :: Group still counts frames after its files were flushed.");
+	}
+
+	// a group at its quota passes over its own high priority page like any other miss would
+	BufMgr capped(10);
+	capped.setQuota(file1ptr, 0, 3);
+	capped.readPage(file1ptr, 1, page, PagePriority::HIGH);
+	capped.unPinPage(file1ptr, 1, false);
+	scanPages(capped, file1ptr, 2, 4);
+	if (!stillResident(capped, 1) || capped.residentPages(file1ptr) != 3)
+	{
+		PRINT_ERROR("ERROR :: Group at its quota evicted its high priority page first.");
+	}
+	capped.flushFile(file1ptr);
+
+	std::cout << "Test 34 passed" << "\n";
+}
@@ -6,6 +6,7 @@
  */
 
 #include <cassert>
+#include <cstring>
 
 #include "exceptions/insufficient_space_exception.h"
 #include "exceptions/invalid_record_exception.h"
@@ -16,10 +17,36 @@
 
 namespace badgerdb {
 
-Page::Page() {
+Page::Page()
+    : owned_(new char[SIZE]),
+      bytes_(owned_.get()),
+      header_(*reinterpret_cast<PageHeader*>(bytes_)),
+      data_(bytes_ + sizeof(PageHeader)) {
   initialize();
 }
 
+Page::Page(char* bytes)
+    : bytes_(bytes),
+      header_(*reinterpret_cast<PageHeader*>(bytes_)),
+      data_(bytes_ + sizeof(PageHeader)) {
+  initialize();
+}
+
+Page::Page(const Page& other)
+    : owned_(new char[SIZE]),
+      bytes_(owned_.get()),
+      header_(*reinterpret_cast<PageHeader*>(bytes_)),
+      data_(bytes_ + sizeof(PageHeader)) {
+  std::memcpy(bytes_, other.bytes_, SIZE);
+}
+
+Page& Page::operator=(const Page& other) {
+  if (this != &other) {
+    std::memcpy(bytes_, other.bytes_, SIZE);
+  }
+  return *this;
+}
+
 void Page::initialize() {
   header_.free_space_lower_bound = 0;
   header_.free_space_upper_bound = DATA_SIZE;
@@ -27,23 +54,35 @@ void Page::initialize() {
   header_.num_free_slots = 0;
   header_.current_page_number = INVALID_NUMBER;
   header_.next_page_number = INVALID_NUMBER;
-  data_.assign(DATA_SIZE, char());
+  std::memset(data_, 0, DATA_SIZE);
 }
 
 RecordId Page::insertRecord(const std::string& record_data) {
-  if (!hasSpaceForRecord(record_data)) {
+  RecordId record_id;
+  if (tryInsertRecord(record_data, record_id) != Status::OK) {
     throw InsufficientSpaceException(
         page_number(), record_data.length(), getFreeSpace());
   }
+  return record_id;
+}
+
+Status Page::tryInsertRecord(const std::string& record_data,
+                             RecordId& record_id) noexcept {
+  if (!hasSpaceForRecord(record_data)) {
+    return Status::INSUFFICIENT_SPACE;
+  }
+  // The slot comes from the page's own slot array, so it is always valid and
+  // free, and inserting into it cannot throw.
   const SlotId slot_number = getAvailableSlot();
   insertRecordInSlot(slot_number, record_data);
-  return {page_number(), slot_number};
+  record_id = {page_number(), slot_number};
+  return Status::OK;
 }
 
 std::string Page::getRecord(const RecordId& record_id) const {
   validateRecordId(record_id);
   const PageSlot& slot = getSlot(record_id.slot_number);
-  return data_.substr(slot.item_offset, slot.item_length);
+  return std::string(data_ + slot.item_offset, slot.item_length);
 }
 
 void Page::updateRecord(const RecordId& record_id,
@@ -71,7 +110,7 @@ void Page::deleteRecord(const RecordId& record_id,
                         const bool allow_slot_compaction) {
   validateRecordId(record_id);
   PageSlot* slot = getSlot(record_id.slot_number);
-  data_.replace(slot->item_offset, slot->item_length, slot->item_length, '\0');
+  std::memset(data_ + slot->item_offset, 0, slot->item_length);
 
   // Compact the data by removing the hole left by this record (if necessary).
   std::uint16_t move_offset = slot->item_offset; 
@@ -90,8 +129,8 @@ void Page::deleteRecord(const RecordId& record_id,
   }
   // If we have data to move, shift it to the right.
   if (move_bytes > 0) {
-    const std::string& data_to_move = data_.substr(move_offset, move_bytes);
-    data_.replace(move_offset + slot->item_length, move_bytes, data_to_move);
+    std::memmove(data_ + move_offset + slot->item_length, data_ + move_offset,
+                 move_bytes);
   }
   header_.free_space_upper_bound += slot->item_length;
 
@@ -131,11 +170,11 @@ bool Page::hasSpaceForRecord(const std::string& record_data) const {
 }
 
 PageSlot* Page::getSlot(const SlotId slot_number) {
-  return reinterpret_cast<PageSlot*>(&data_[(slot_number - 1) * sizeof(PageSlot)]);
+  return reinterpret_cast<PageSlot*>(data_ + (slot_number - 1) * sizeof(PageSlot));
 }
 
 const PageSlot& Page::getSlot(const SlotId slot_number) const {
-  return *reinterpret_cast<const PageSlot*>(&data_[(slot_number - 1) * sizeof(PageSlot)]);
+  return *reinterpret_cast<const PageSlot*>(data_ + (slot_number - 1) * sizeof(PageSlot));
 }
 
 SlotId Page::getAvailableSlot() {
@@ -178,7 +217,7 @@ void Page::insertRecordInSlot(const SlotId slot_number,
   slot->item_offset = header_.free_space_upper_bound - record_length;
   header_.free_space_upper_bound = slot->item_offset;
   --header_.num_free_slots;
-  data_.replace(slot->item_offset, slot->item_length, record_data);
+  std::memcpy(data_ + slot->item_offset, record_data.data(), slot->item_length);
 }
 
 void Page::validateRecordId(const RecordId& record_id) const {
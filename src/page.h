@@ -12,6 +12,7 @@
 #include <memory>
 #include <string>
 
+#include "status.h"
 #include "types.h"
 
 namespace badgerdb {
@@ -102,6 +103,12 @@ class PageIterator;
  * slots and identified by a RecordId.  Although a record's actual contents may
  * be moved on the page, accessing a record by its slot is consistent.
  *
+ * The header and data of a page are stored together in Page::SIZE contiguous
+ * bytes, laid out exactly as on disk.  A page constructed by the user owns its
+ * bytes; a page in the buffer pool is a view over its frame's bytes in the
+ * pool's arena.  Copying a page copies the bytes, and assigning to a view
+ * writes into the memory it views.
+ *
  * @warning This class is not threadsafe.
  */
 class Page {
@@ -132,6 +139,22 @@ class Page {
    */
   Page();
 
+  /**
+   * Constructs a page that owns a copy of another page's bytes.
+   *
+   * @param other  Page to copy.
+   */
+  Page(const Page& other);
+
+  /**
+   * Copies another page's bytes over this page's, leaving this page a view if
+   * it is one.
+   *
+   * @param other  Page to copy.
+   * @return  This page.
+   */
+  Page& operator=(const Page& other);
+
   /**
    * Inserts a new record into the page.
    *
@@ -140,6 +163,19 @@ class Page {
    */
   RecordId insertRecord(const std::string& record_data);
 
+  /**
+   * Inserts a new record into the page if it fits, reporting a full page as a
+   * status rather than an exception.
+   *
+   * @param record_data  Bytes that compose the record.
+   * @param record_id    ID of the newly inserted record is returned via this
+   *                     reference.
+   * @return  Status::OK, or Status::INSUFFICIENT_SPACE if the page is too full,
+   *          in which case the page is left alone.
+   */
+  Status tryInsertRecord(const std::string& record_data,
+                         RecordId& record_id) noexcept;
+
   /**
    * Returns the record with the given ID.  Returned data is a copy of what is
    * stored on the page; use updateRecord to change it.
@@ -215,6 +251,14 @@ class Page {
   PageIterator end();
 
  private:
+  /**
+   * Constructs a new, uninitialized page over bytes it does not own, such as a
+   * buffer pool frame.
+   *
+   * @param bytes  Page::SIZE bytes, aligned for PageHeader, that outlive the page.
+   */
+  explicit Page(char* bytes);
+
   /**
    * Initializes this page as a new page with no header information or data.
    */
@@ -321,17 +365,27 @@ class Page {
   bool isUsed() const { return page_number() != INVALID_NUMBER; }
 
   /**
-   * Header metadata.
+   * Storage of a page that owns its bytes; empty for a view.
    */
-  PageHeader header_;
+  std::unique_ptr<char[]> owned_;
 
   /**
-   * Data stored on the page.  Includes bookkeeping information about slots as
-   * well as actual content.
+   * The page's Page::SIZE bytes: header, then data.
    */
+  char* bytes_;
 
-  std::string data_;
+  /**
+   * Header metadata, at the start of bytes_.
+   */
+  PageHeader& header_;
+
+  /**
+   * Data stored on the page, the DATA_SIZE bytes after the header.  Includes
+   * bookkeeping information about slots as well as actual content.
+   */
+  char* data_;
 
+  friend class BufMgr;
   friend class File;
   friend class PageIterator;
   friend class PageTest;
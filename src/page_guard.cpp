@@ -0,0 +1,27 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "page_guard.h"
+
+#include "buffer.h"
+
+namespace badgerdb {
+
+void PageGuard::release() {
+  if (bufMgr == NULL) {
+    return;
+  }
+  BufMgr* holder = bufMgr;
+  bufMgr = NULL;
+  holder->unPinFrame(frameNo, file, pageNo, dirty);
+}
+
+Page* PageGuard::get() const {
+  return bufMgr == NULL ? NULL : &bufMgr->bufPool[frameNo];
+}
+
+}
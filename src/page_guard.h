@@ -0,0 +1,153 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include "file.h"
+#include "page.h"
+#include "types.h"
+
+namespace badgerdb {
+
+class BufMgr;
+
+/**
+ * @brief Pin on a page in the buffer pool that is released when the guard goes away.
+ *
+ * Returned by the BufMgr::readPage() and BufMgr::allocPage() overloads that take no page pointer.
+ * The guard remembers the frame the page is in, so unpinning does not look the page up in the hash
+ * table again. Guards can be moved but not copied; a moved-from or released guard holds nothing.
+ *
+ * @warning The BufMgr must outlive every guard it hands out.
+ */
+class PageGuard {
+ public:
+  /**
+   * Constructs a guard that holds no page.
+   */
+  PageGuard()
+      : bufMgr(NULL), frameNo(0), file(NULL), pageNo(Page::INVALID_NUMBER), dirty(false) {}
+
+  /**
+   * Takes over the pin held by other, which is left empty.
+   */
+  PageGuard(PageGuard&& other)
+      : bufMgr(other.bufMgr),
+        frameNo(other.frameNo),
+        file(other.file),
+        pageNo(other.pageNo),
+        dirty(other.dirty) {
+    other.bufMgr = NULL;
+  }
+
+  /**
+   * Releases the page held by this guard, then takes over the pin held by other.
+   */
+  PageGuard& operator=(PageGuard&& other) {
+    if (this != &other) {
+      release();
+      bufMgr = other.bufMgr;
+      frameNo = other.frameNo;
+      file = other.file;
+      pageNo = other.pageNo;
+      dirty = other.dirty;
+      other.bufMgr = NULL;
+    }
+    return *this;
+  }
+
+  PageGuard(const PageGuard&) = delete;
+  PageGuard& operator=(const PageGuard&) = delete;
+
+  /**
+   * Unpins the page, marking it dirty if markDirty() was called.
+   */
+  ~PageGuard() {
+    release();
+  }
+
+  /**
+   * Unpins the page now rather than when the guard is destroyed. Does nothing if the guard is
+   * empty.
+   */
+  void release();
+
+  /**
+   * Has the page written back before it leaves the buffer pool.
+   */
+  void markDirty() {
+    dirty = true;
+  }
+
+  /**
+   * Returns true if the guard holds a page.
+   */
+  explicit operator bool() const {
+    return bufMgr != NULL;
+  }
+
+  /**
+   * Returns the page held by the guard, NULL if it is empty.
+   */
+  Page* get() const;
+
+  Page* operator->() const {
+    return get();
+  }
+
+  Page& operator*() const {
+    return *get();
+  }
+
+  /**
+   * Returns the number of the page held by the guard.
+   */
+  PageId page_number() const {
+    return pageNo;
+  }
+
+ private:
+  friend class BufMgr;
+
+  /**
+   * Constructs a guard for a pin the caller has already taken.
+   *
+   * @param bufMgrIn    Buffer manager holding the page
+   * @param frameNoIn   Frame the page is in
+   * @param fileIn      File of the page
+   * @param pageNoIn    Page number in the file
+   */
+  PageGuard(BufMgr* bufMgrIn, const FrameId frameNoIn, File* fileIn, const PageId pageNoIn)
+      : bufMgr(bufMgrIn), frameNo(frameNoIn), file(fileIn), pageNo(pageNoIn), dirty(false) {}
+
+  /**
+   * Buffer manager holding the page, NULL if the guard is empty
+   */
+  BufMgr* bufMgr;
+
+  /**
+   * Frame the page is in
+   */
+  FrameId frameNo;
+
+  /**
+   * File of the page
+   */
+  File* file;
+
+  /**
+   * Page number in the file
+   */
+  PageId pageNo;
+
+  /**
+   * True once markDirty() has been called
+   */
+  bool dirty;
+};
+
+}
@@ -0,0 +1,117 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+
+#include "replacement_policy.h"
+
+namespace badgerdb {
+
+/**
+ * @brief Hits recorded by many threads, for a policy to apply to its order in batches.
+ *
+ * Policies that keep their pages in an order guarded by one latch would take that latch on every
+ * hit. Instead, accessed() records the frame in the calling thread's shard, which only threads
+ * sharing the shard contend on, and the policy applies the recorded hits under its latch when a
+ * shard fills and before it next looks at the order. A hit may therefore be applied after its
+ * page was evicted and the frame given another, which only makes that page look a little hotter,
+ * and a hit that finds its shard full is dropped.
+ */
+class AccessLog {
+ public:
+  /**
+   * Number of shards; threads beyond this many share
+   */
+  static const std::size_t NUM_SHARDS = 16;
+
+  /**
+   * Hits a shard holds before it must be applied
+   */
+  static const std::size_t SHARD_SIZE = 64;
+
+  AccessLog() {
+    for (std::size_t i = 0; i < NUM_SHARDS; i++) {
+      shards_[i] = new Shard();
+    }
+  }
+
+  ~AccessLog() {
+    for (std::size_t i = 0; i < NUM_SHARDS; i++) {
+      delete shards_[i];
+    }
+  }
+
+  AccessLog(const AccessLog&) = delete;
+  AccessLog& operator=(const AccessLog&) = delete;
+
+  /**
+   * Records a hit on frame.
+   *
+   * @return  True if the calling thread's shard is full and the policy should apply it
+   */
+  bool record(const FrameId frame) {
+    Shard& shard = *shards_[shardOf()];
+    std::lock_guard<std::mutex> guard(shard.latch);
+    if (shard.count < SHARD_SIZE) {
+      shard.frames[shard.count++] = frame;
+    }
+    return shard.count == SHARD_SIZE;
+  }
+
+  /**
+   * Empties every shard, calling apply(frame) for each hit in the order the shard recorded them.
+   * Caller holds the policy's latch, which is taken before any shard's.
+   */
+  template <typename Apply>
+  void drain(Apply apply) {
+    FrameId frames[SHARD_SIZE];
+    for (std::size_t i = 0; i < NUM_SHARDS; i++) {
+      std::size_t count;
+      {
+        std::lock_guard<std::mutex> guard(shards_[i]->latch);
+        count = shards_[i]->count;
+        for (std::size_t j = 0; j < count; j++) {
+          frames[j] = shards_[i]->frames[j];
+        }
+        shards_[i]->count = 0;
+      }
+      for (std::size_t j = 0; j < count; j++) {
+        apply(frames[j]);
+      }
+    }
+  }
+
+ private:
+  /**
+   * Hits recorded by the threads assigned to one shard. Each shard is a separate allocation, so
+   * no two share a cache line.
+   */
+  struct Shard {
+    Shard() : count(0) {}
+
+    std::mutex latch;
+    std::size_t count;
+    FrameId frames[SHARD_SIZE];
+  };
+
+  /**
+   * Shard of the calling thread, fixed for the life of the thread and shared by every log
+   */
+  static std::size_t shardOf() {
+    static std::atomic<std::size_t> nextShard(0);
+    static thread_local const std::size_t shard = nextShard.fetch_add(1) % NUM_SHARDS;
+    return shard;
+  }
+
+  Shard* shards_[NUM_SHARDS];
+};
+
+}
@@ -0,0 +1,198 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "arc_policy.h"
+
+#include <algorithm>
+
+#include "file.h"
+
+namespace badgerdb {
+
+ArcPolicy::ArcPolicy(const std::uint32_t numBufs)
+    : capacity(numBufs),
+      target(0),
+      queueOf(numBufs, NONE),
+      positions(numBufs),
+      pinnedFrames(numBufs, false),
+      listedFree(numBufs, false) {
+  for (FrameId i = numBufs; i > 0; i--) {
+    pushFree(i - 1);
+  }
+}
+
+void ArcPolicy::unlink(const FrameId frame) {
+  if (queueOf[frame] == T1) {
+    t1.erase(positions[frame]);
+  } else if (queueOf[frame] == T2) {
+    t2.erase(positions[frame]);
+  }
+  queueOf[frame] = NONE;
+}
+
+void ArcPolicy::pushFront(const FrameId frame, const Queue queue) {
+  std::list<FrameId>& list = queue == T1 ? t1 : t2;
+  list.push_front(frame);
+  positions[frame] = list.begin();
+  queueOf[frame] = queue;
+}
+
+void ArcPolicy::pushFree(const FrameId frame) {
+  if (!listedFree[frame]) {
+    listedFree[frame] = true;
+    freeFrames.push_back(frame);
+  }
+}
+
+void ArcPolicy::trimGhosts() {
+  while (t1.size() + b1.size() > capacity && b1.popBack()) {
+  }
+  while (t1.size() + t2.size() + b1.size() + b2.size() > 2 * capacity && b2.popBack()) {
+  }
+}
+
+bool ArcPolicy::oldestUnpinned(const std::list<FrameId>& queue, FrameId& frame) const {
+  for (std::list<FrameId>::const_reverse_iterator it = queue.rbegin(); it != queue.rend(); ++it) {
+    if (!pinnedFrames[*it]) {
+      frame = *it;
+      return true;
+    }
+  }
+  return false;
+}
+
+void ArcPolicy::appendUnpinned(const std::list<FrameId>& queue, std::vector<FrameId>& frames,
+                                const std::size_t max) const {
+  for (std::list<FrameId>::const_reverse_iterator it = queue.rbegin();
+       it != queue.rend() && frames.size() < max; ++it) {
+    if (!pinnedFrames[*it]) {
+      frames.push_back(*it);
+    }
+  }
+}
+
+void ArcPolicy::accessed(const FrameId frame) {
+  if (accesses.record(frame)) {
+    std::lock_guard<std::mutex> guard(latch);
+    applyAccesses();
+  }
+}
+
+void ArcPolicy::hit(const FrameId frame) {
+  if (queueOf[frame] != NONE) {
+    unlink(frame);
+    pushFront(frame, T2);
+  }
+}
+
+void ArcPolicy::applyAccesses() {
+  accesses.drain([this](const FrameId frame) { hit(frame); });
+}
+
+void ArcPolicy::loaded(const FrameId frame, const File* file, const PageId pageNo) {
+  std::lock_guard<std::mutex> guard(latch);
+  const GhostKey key(file->id(), pageNo);
+  unlink(frame);
+  if (b1.contains(key)) {
+    const std::size_t delta = b2.size() > b1.size() ? b2.size() / b1.size() : 1;
+    target = target + delta < capacity ? target + delta : capacity;
+    b1.erase(key);
+    pushFront(frame, T2);
+  } else if (b2.contains(key)) {
+    const std::size_t delta = b1.size() > b2.size() ? b1.size() / b2.size() : 1;
+    target = target > delta ? target - delta : 0;
+    b2.erase(key);
+    pushFront(frame, T2);
+  } else {
+    pushFront(frame, T1);
+  }
+  trimGhosts();
+}
+
+void ArcPolicy::pinned(const FrameId frame) {
+  std::lock_guard<std::mutex> guard(latch);
+  pinnedFrames[frame] = true;
+}
+
+void ArcPolicy::unpinned(const FrameId frame) {
+  std::lock_guard<std::mutex> guard(latch);
+  pinnedFrames[frame] = false;
+  if (queueOf[frame] == NONE) {
+    pushFree(frame);
+  }
+}
+
+void ArcPolicy::evicted(const FrameId frame, const FileId fileId, const PageId pageNo) {
+  std::lock_guard<std::mutex> guard(latch);
+  if (queueOf[frame] == T1) {
+    b1.pushFront(GhostKey(fileId, pageNo));
+  } else if (queueOf[frame] == T2) {
+    b2.pushFront(GhostKey(fileId, pageNo));
+  }
+  unlink(frame);
+  trimGhosts();
+}
+
+void ArcPolicy::freed(const FrameId frame) {
+  std::lock_guard<std::mutex> guard(latch);
+  unlink(frame);
+  if (!pinnedFrames[frame]) {
+    pushFree(frame);
+  }
+}
+
+bool ArcPolicy::pickVictim(FrameId& frame) {
+  std::lock_guard<std::mutex> guard(latch);
+  applyAccesses();
+  while (!freeFrames.empty()) {
+    const FrameId candidate = freeFrames.back();
+    if (!pinnedFrames[candidate] && queueOf[candidate] == NONE) {
+      frame = candidate;
+      return true;
+    }
+    freeFrames.pop_back();
+    listedFree[candidate] = false;
+  }
+
+  if (!t1.empty() && t1.size() >= (target > 0 ? target : 1)) {
+    return oldestUnpinned(t1, frame) || oldestUnpinned(t2, frame);
+  }
+  return oldestUnpinned(t2, frame) || oldestUnpinned(t1, frame);
+}
+
+void ArcPolicy::evictionCandidates(std::vector<FrameId>& frames, const std::size_t max) {
+  std::lock_guard<std::mutex> guard(latch);
+  applyAccesses();
+  frames.clear();
+  const bool t1First = !t1.empty() && t1.size() >= (target > 0 ? target : 1);
+  appendUnpinned(t1First ? t1 : t2, frames, max);
+  appendUnpinned(t1First ? t2 : t1, frames, max);
+}
+
+void ArcPolicy::resize(const std::uint32_t numBufs) {
+  std::lock_guard<std::mutex> guard(latch);
+  applyAccesses();
+  const std::uint32_t oldBufs = queueOf.size();
+  // frames being released are empty and pinned, so only stale free list entries can name them
+  freeFrames.erase(std::remove_if(freeFrames.begin(), freeFrames.end(),
+                                  [numBufs](const FrameId frame) { return frame >= numBufs; }),
+                   freeFrames.end());
+  queueOf.resize(numBufs, NONE);
+  positions.resize(numBufs);
+  pinnedFrames.resize(numBufs, false);
+  listedFree.resize(numBufs, false);
+  capacity = numBufs;
+  if (target > capacity) {
+    target = capacity;
+  }
+  trimGhosts();
+  for (FrameId i = numBufs; i > oldBufs; i--) {
+    pushFree(i - 1);
+  }
+}
+
+}
@@ -0,0 +1,164 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <list>
+#include <mutex>
+#include <vector>
+
+#include "access_log.h"
+#include "ghost_list.h"
+#include "replacement_policy.h"
+
+namespace badgerdb {
+
+/**
+ * @brief Adaptive Replacement Cache (Megiddo and Modha).
+ *
+ * T1 holds pages referenced once recently and T2 pages referenced at least twice; B1 and B2
+ * remember pages recently evicted from each. A miss on a page in B1 means T1 was too small and
+ * grows the target size p of T1; a miss on a page in B2 shrinks it. Victims come from T1 while
+ * it is larger than p and from T2 otherwise.
+ *
+ * Hits are collected in an AccessLog and move their pages to T2 in batches.
+ */
+class ArcPolicy : public ReplacementPolicy {
+ public:
+  /**
+   * Constructor of ArcPolicy class
+   *
+   * @param numBufs   Number of frames in the buffer pool
+   */
+  explicit ArcPolicy(const std::uint32_t numBufs);
+
+  void accessed(const FrameId frame) override;
+  void loaded(const FrameId frame, const File* file, const PageId pageNo) override;
+  void pinned(const FrameId frame) override;
+  void unpinned(const FrameId frame) override;
+  void evicted(const FrameId frame, const FileId fileId, const PageId pageNo) override;
+  void freed(const FrameId frame) override;
+  bool pickVictim(FrameId& frame) override;
+  void evictionCandidates(std::vector<FrameId>& frames, const std::size_t max) override;
+  void resize(const std::uint32_t numBufs) override;
+
+ private:
+  /**
+   * List a resident frame is on
+   */
+  enum Queue { NONE, T1, T2 };
+
+  /**
+   * Takes frame off the list it is on.
+   */
+  void unlink(const FrameId frame);
+
+  /**
+   * Applies a hit on frame to the order. Caller holds latch.
+   */
+  void hit(const FrameId frame);
+
+  /**
+   * Applies every hit recorded in accesses. Caller holds latch.
+   */
+  void applyAccesses();
+
+  /**
+   * Puts frame at the most recently used end of list.
+   */
+  void pushFront(const FrameId frame, const Queue queue);
+
+  /**
+   * Adds frame to freeFrames unless it is already there.
+   */
+  void pushFree(const FrameId frame);
+
+  /**
+   * Drops the oldest ghosts so the lists stay within the sizes ARC allows.
+   */
+  void trimGhosts();
+
+  /**
+   * Finds the least recently used unpinned frame of a list.
+   *
+   * @return  False if every frame on the list is pinned
+   */
+  bool oldestUnpinned(const std::list<FrameId>& queue, FrameId& frame) const;
+
+  /**
+   * Appends the unpinned frames of a queue, oldest first, until frames holds max entries.
+   */
+  void appendUnpinned(const std::list<FrameId>& queue, std::vector<FrameId>& frames,
+                      const std::size_t max) const;
+
+  /**
+   * Number of frames in the buffer pool
+   */
+  std::size_t capacity;
+
+  /**
+   * Target size of T1
+   */
+  std::size_t target;
+
+  /**
+   * Resident pages referenced once, most recently used first
+   */
+  std::list<FrameId> t1;
+
+  /**
+   * Resident pages referenced more than once, most recently used first
+   */
+  std::list<FrameId> t2;
+
+  /**
+   * Pages evicted from T1, newest first
+   */
+  GhostList b1;
+
+  /**
+   * Pages evicted from T2, newest first
+   */
+  GhostList b2;
+
+  /**
+   * List each frame is on
+   */
+  std::vector<Queue> queueOf;
+
+  /**
+   * Position of each listed frame on its list
+   */
+  std::vector<std::list<FrameId>::iterator> positions;
+
+  /**
+   * True while the frame's pin count is above zero
+   */
+  std::vector<bool> pinnedFrames;
+
+  /**
+   * Empty frames. Entries that have since been pinned or loaded are skipped.
+   */
+  std::vector<FrameId> freeFrames;
+
+  /**
+   * True while the frame has an entry in freeFrames
+   */
+  std::vector<bool> listedFree;
+
+  /**
+   * Guards all of the above
+   */
+  std::mutex latch;
+
+  /**
+   * Hits on resident frames not yet applied, recorded by accessed() without taking latch
+   */
+  AccessLog accesses;
+};
+
+}
@@ -0,0 +1,164 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "clock_policy.h"
+
+namespace badgerdb {
+
+namespace {
+
+std::uint32_t capacityOf(const std::uint32_t bufs, const std::uint32_t maxBufs) {
+  return maxBufs > bufs ? maxBufs : bufs;
+}
+
+}
+
+ClockPolicy::ClockPolicy(const std::uint32_t bufs, const std::uint32_t maxBufs)
+    : numBufs(bufs),
+      clockHand(bufs - 1),
+      sweepSteps(0),
+      refbits(new std::atomic<bool>[capacityOf(bufs, maxBufs)]),
+      pinnedFrames(new std::atomic<bool>[capacityOf(bufs, maxBufs)]),
+      freeHead(NO_FRAME),
+      freeNext(new FrameId[capacityOf(bufs, maxBufs)]),
+      listedFree(new std::atomic<bool>[capacityOf(bufs, maxBufs)]) {
+  for (FrameId i = 0; i < capacityOf(bufs, maxBufs); i++) {
+    refbits[i] = false;
+    pinnedFrames[i] = false;
+    listedFree[i] = false;
+  }
+  // lowest frame on top, so an empty pool fills in frame order as it always has
+  for (FrameId i = bufs; i > 0; i--) {
+    pushFree(i - 1);
+  }
+}
+
+ClockPolicy::~ClockPolicy() {
+  delete[] refbits;
+  delete[] pinnedFrames;
+  delete[] freeNext;
+  delete[] listedFree;
+}
+
+void ClockPolicy::advanceClock() {
+  clockHand.store((clockHand.load(std::memory_order_relaxed) + 1) %
+                      numBufs.load(std::memory_order_relaxed),
+                  std::memory_order_relaxed);
+}
+
+void ClockPolicy::pushFree(const FrameId frame) {
+  if (listedFree[frame].exchange(true, std::memory_order_acq_rel)) {
+    return;
+  }
+  FrameId head = freeHead.load(std::memory_order_relaxed);
+  do {
+    freeNext[frame] = head;
+  } while (!freeHead.compare_exchange_weak(head, frame, std::memory_order_release,
+                                           std::memory_order_relaxed));
+}
+
+void ClockPolicy::accessed(const FrameId frame) {
+  refbits[frame].store(true, std::memory_order_relaxed);
+}
+
+void ClockPolicy::loaded(const FrameId frame, const File* file, const PageId pageNo) {
+  refbits[frame].store(true, std::memory_order_relaxed);
+}
+
+void ClockPolicy::pinned(const FrameId frame) {
+  pinnedFrames[frame].store(true, std::memory_order_relaxed);
+}
+
+void ClockPolicy::unpinned(const FrameId frame) {
+  pinnedFrames[frame].store(false, std::memory_order_relaxed);
+}
+
+void ClockPolicy::evicted(const FrameId frame, const FileId fileId, const PageId pageNo) {
+  refbits[frame].store(false, std::memory_order_relaxed);
+}
+
+void ClockPolicy::freed(const FrameId frame) {
+  refbits[frame].store(false, std::memory_order_relaxed);
+  pushFree(frame);
+}
+
+bool ClockPolicy::pickVictim(FrameId& frame) {
+  const std::uint32_t bufs = numBufs.load(std::memory_order_relaxed);
+  sweepSteps = 0;
+
+  // only this thread pops, so the top cannot be popped and pushed again under us
+  FrameId head = freeHead.load(std::memory_order_acquire);
+  while (head != NO_FRAME) {
+    if (!freeHead.compare_exchange_weak(head, freeNext[head], std::memory_order_acquire,
+                                        std::memory_order_acquire)) {
+      continue;
+    }
+    listedFree[head].store(false, std::memory_order_release);
+    // the hand may have handed the frame out since it was freed
+    if (head < bufs && !pinnedFrames[head].load(std::memory_order_relaxed) &&
+        !refbits[head].load(std::memory_order_relaxed)) {
+      frame = head;
+      return true;
+    }
+    head = freeHead.load(std::memory_order_acquire);
+  }
+
+  // a full revolution over pinned frames means every frame in the pool is pinned
+  std::uint32_t pinnedCount = 0;
+  while (pinnedCount < bufs) {
+    advanceClock();
+    sweepSteps++;
+    const FrameId hand = clockHand.load(std::memory_order_relaxed);
+    if (pinnedFrames[hand].load(std::memory_order_relaxed)) {
+      pinnedCount++;
+      continue;
+    }
+    pinnedCount = 0;
+    if (refbits[hand].exchange(false, std::memory_order_relaxed)) {
+      continue;
+    }
+    frame = hand;
+    return true;
+  }
+  return false;
+}
+
+void ClockPolicy::evictionCandidates(std::vector<FrameId>& frames, const std::size_t max) {
+  // frames the hand would take on its next pass, starting just ahead of it, then the referenced
+  // ones it would take on the pass after that
+  frames.clear();
+  const FrameId hand = clockHand.load(std::memory_order_relaxed);
+  const std::uint32_t bufs = numBufs.load(std::memory_order_relaxed);
+  for (int pass = 0; pass < 2; pass++) {
+    for (std::uint32_t i = 1; i <= bufs && frames.size() < max; i++) {
+      const FrameId frame = (hand + i) % bufs;
+      if (!pinnedFrames[frame].load(std::memory_order_relaxed) &&
+          refbits[frame].load(std::memory_order_relaxed) == (pass == 1)) {
+        frames.push_back(frame);
+      }
+    }
+  }
+}
+
+std::uint32_t ClockPolicy::lastSweepSteps() const {
+  return sweepSteps;
+}
+
+void ClockPolicy::resize(const std::uint32_t bufs) {
+  // frames released earlier were left pinned; hand them back clear
+  const std::uint32_t oldBufs = numBufs.load(std::memory_order_relaxed);
+  for (FrameId i = oldBufs; i < bufs; i++) {
+    refbits[i].store(false, std::memory_order_relaxed);
+    pinnedFrames[i].store(false, std::memory_order_relaxed);
+  }
+  numBufs.store(bufs, std::memory_order_relaxed);
+  for (FrameId i = bufs; i > oldBufs; i--) {
+    pushFree(i - 1);
+  }
+}
+
+}
@@ -0,0 +1,115 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <atomic>
+
+#include "replacement_policy.h"
+
+namespace badgerdb {
+
+/**
+ * @brief Single reference bit clock, the policy BufMgr has always used.
+ *
+ * The hand sweeps the frames in order, clearing reference bits, and stops at the first unpinned
+ * frame whose bit is already clear. Empty frames never have their bit set, so they are taken as
+ * soon as the hand reaches them, but frames that are empty from the start or emptied by freed()
+ * are also pushed on a free stack that pickVictim() pops before it moves the hand at all. Hooks
+ * only store to per-frame atomics, and freed() pushes without a latch; only pickVictim() pops.
+ */
+class ClockPolicy : public ReplacementPolicy {
+ public:
+  /**
+   * Constructor of ClockPolicy class
+   *
+   * @param numBufs   Number of frames in the buffer pool
+   * @param maxBufs   Most frames the pool will ever be resized to; numBufs if smaller
+   */
+  explicit ClockPolicy(const std::uint32_t numBufs, const std::uint32_t maxBufs = 0);
+
+  /**
+   * Destructor of ClockPolicy class
+   */
+  ~ClockPolicy();
+
+  void accessed(const FrameId frame) override;
+  void loaded(const FrameId frame, const File* file, const PageId pageNo) override;
+  void pinned(const FrameId frame) override;
+  void unpinned(const FrameId frame) override;
+  void evicted(const FrameId frame, const FileId fileId, const PageId pageNo) override;
+  void freed(const FrameId frame) override;
+  bool pickVictim(FrameId& frame) override;
+  void evictionCandidates(std::vector<FrameId>& frames, const std::size_t max) override;
+  void resize(const std::uint32_t numBufs) override;
+  std::uint32_t lastSweepSteps() const override;
+
+ private:
+  /**
+   * Advance clock to next frame in the buffer pool
+   */
+  void advanceClock();
+
+  /**
+   * Pushes frame on the free stack unless it is already there.
+   *
+   * @param frame   Frame that is empty
+   */
+  void pushFree(const FrameId frame);
+
+  /**
+   * Marks the bottom of the free stack
+   */
+  static const FrameId NO_FRAME = ~0u;
+
+  /**
+   * Number of frames in the buffer pool. Only resize() changes it, but evictionCandidates() reads
+   * it from other threads.
+   */
+  std::atomic<std::uint32_t> numBufs;
+
+  /**
+   * Current position of clockhand in our buffer pool. Only pickVictim() moves it, but
+   * evictionCandidates() reads it from other threads.
+   */
+  std::atomic<FrameId> clockHand;
+
+  /**
+   * Frames the hand moved past during the last pickVictim()
+   */
+  std::uint32_t sweepSteps;
+
+  /**
+   * Has this buffer frame been reference recently. This and pinnedFrames are allocated for the
+   * largest size the pool can grow to, since hooks read them without a latch.
+   */
+  std::atomic<bool>* refbits;
+
+  /**
+   * True while the frame's pin count is above zero
+   */
+  std::atomic<bool>* pinnedFrames;
+
+  /**
+   * Top of the stack of empty frames, NO_FRAME if it is empty
+   */
+  std::atomic<FrameId> freeHead;
+
+  /**
+   * Frame below each frame on the free stack. Written only by whoever pushes the frame, which
+   * nobody else can do until pickVictim() has popped it.
+   */
+  FrameId* freeNext;
+
+  /**
+   * True while the frame is on the free stack. An entry is only a hint: a frame the hand took
+   * meanwhile is skipped when it is popped.
+   */
+  std::atomic<bool>* listedFree;
+};
+
+}
@@ -0,0 +1,256 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "clock_pro_policy.h"
+
+#include <algorithm>
+
+#include "file.h"
+
+namespace badgerdb {
+
+namespace {
+
+std::uint32_t capacityOf(const std::uint32_t bufs, const std::uint32_t maxBufs) {
+  return maxBufs > bufs ? maxBufs : bufs;
+}
+
+}
+
+ClockProPolicy::ClockProPolicy(const std::uint32_t numBufs, const std::uint32_t maxBufs)
+    : capacity(numBufs),
+      coldTarget(numBufs / 2 > 0 ? numBufs / 2 : 1),
+      hotCount(0),
+      coldHand(numBufs - 1),
+      sweepSteps(0),
+      hotHand(numBufs - 1),
+      frames(numBufs),
+      listedFree(numBufs, false),
+      referenced(new std::atomic<bool>[capacityOf(numBufs, maxBufs)]) {
+  for (FrameId i = 0; i < capacityOf(numBufs, maxBufs); i++) {
+    referenced[i] = false;
+  }
+  for (FrameId i = numBufs; i > 0; i--) {
+    FrameState& state = frames[i - 1];
+    state.status = EMPTY;
+    state.inTest = false;
+    state.pinned = false;
+    pushFree(i - 1);
+  }
+}
+
+ClockProPolicy::~ClockProPolicy() {
+  delete[] referenced;
+}
+
+void ClockProPolicy::pushFree(const FrameId frame) {
+  if (!listedFree[frame]) {
+    listedFree[frame] = true;
+    freeFrames.push_back(frame);
+  }
+}
+
+bool ClockProPolicy::runHotHand() {
+  for (std::uint32_t steps = 0; steps < 2 * capacity; steps++) {
+    hotHand = (hotHand + 1) % capacity;
+    FrameState& state = frames[hotHand];
+    if (state.status != HOT || state.pinned) {
+      continue;
+    }
+    if (referenced[hotHand].exchange(false, std::memory_order_relaxed)) {
+      continue;
+    }
+    state.status = COLD;
+    state.inTest = false;
+    hotCount--;
+    return true;
+  }
+  return false;
+}
+
+void ClockProPolicy::balanceHot() {
+  while (hotCount > capacity - coldTarget && runHotHand()) {
+  }
+}
+
+void ClockProPolicy::accessed(const FrameId frame) {
+  referenced[frame].store(true, std::memory_order_relaxed);
+}
+
+void ClockProPolicy::loaded(const FrameId frame, const File* file, const PageId pageNo) {
+  std::lock_guard<std::mutex> guard(latch);
+  FrameState& state = frames[frame];
+  referenced[frame].store(false, std::memory_order_relaxed);
+  if (nonResident.erase(GhostKey(file->id(), pageNo))) {
+    // reused within its test period: the cold share was too small
+    if (coldTarget < capacity - 1) {
+      coldTarget++;
+    }
+    state.status = HOT;
+    state.inTest = false;
+    hotCount++;
+    balanceHot();
+  } else {
+    state.status = COLD;
+    state.inTest = true;
+  }
+}
+
+void ClockProPolicy::pinned(const FrameId frame) {
+  std::lock_guard<std::mutex> guard(latch);
+  frames[frame].pinned = true;
+}
+
+void ClockProPolicy::unpinned(const FrameId frame) {
+  std::lock_guard<std::mutex> guard(latch);
+  frames[frame].pinned = false;
+  if (frames[frame].status == EMPTY) {
+    pushFree(frame);
+  }
+}
+
+void ClockProPolicy::evicted(const FrameId frame, const FileId fileId, const PageId pageNo) {
+  std::lock_guard<std::mutex> guard(latch);
+  FrameState& state = frames[frame];
+  if (state.status == HOT) {
+    hotCount--;
+  } else if (state.status == COLD && state.inTest) {
+    nonResident.pushFront(GhostKey(fileId, pageNo));
+    // test periods that ran out without a reuse: the cold share can shrink
+    while (nonResident.size() > capacity && nonResident.popBack()) {
+      if (coldTarget > 1) {
+        coldTarget--;
+      }
+    }
+  }
+  state.status = EMPTY;
+  referenced[frame].store(false, std::memory_order_relaxed);
+  state.inTest = false;
+}
+
+void ClockProPolicy::freed(const FrameId frame) {
+  std::lock_guard<std::mutex> guard(latch);
+  FrameState& state = frames[frame];
+  if (state.status == HOT) {
+    hotCount--;
+  }
+  state.status = EMPTY;
+  referenced[frame].store(false, std::memory_order_relaxed);
+  state.inTest = false;
+  if (!state.pinned) {
+    pushFree(frame);
+  }
+}
+
+bool ClockProPolicy::pickVictim(FrameId& frame) {
+  std::lock_guard<std::mutex> guard(latch);
+  sweepSteps = 0;
+  while (!freeFrames.empty()) {
+    const FrameId candidate = freeFrames.back();
+    if (!frames[candidate].pinned && frames[candidate].status == EMPTY) {
+      frame = candidate;
+      return true;
+    }
+    freeFrames.pop_back();
+    listedFree[candidate] = false;
+  }
+
+  // two passes of the cold hand are enough to clear every reference bit it meets; if they find
+  // nothing, every unpinned page is hot, so demote one and let the cold hand take it
+  for (int attempt = 0; attempt < 2; attempt++) {
+    for (std::uint32_t steps = 0; steps < 2 * capacity; steps++) {
+      coldHand = (coldHand + 1) % capacity;
+      sweepSteps++;
+      FrameState& state = frames[coldHand];
+      if (state.status != COLD || state.pinned) {
+        continue;
+      }
+      if (referenced[coldHand].exchange(false, std::memory_order_relaxed)) {
+        if (state.inTest) {
+          state.status = HOT;
+          state.inTest = false;
+          hotCount++;
+          balanceHot();
+        } else {
+          state.inTest = true;
+        }
+        continue;
+      }
+      frame = coldHand;
+      return true;
+    }
+    if (!runHotHand()) {
+      break;
+    }
+  }
+
+  // everything left unpinned is hot and referenced faster than the hot hand can clear it
+  for (std::uint32_t steps = 0; steps < capacity; steps++) {
+    coldHand = (coldHand + 1) % capacity;
+    sweepSteps++;
+    if (!frames[coldHand].pinned && frames[coldHand].status != EMPTY) {
+      frame = coldHand;
+      return true;
+    }
+  }
+  return false;
+}
+
+std::uint32_t ClockProPolicy::lastSweepSteps() const {
+  return sweepSteps;
+}
+
+void ClockProPolicy::evictionCandidates(std::vector<FrameId>& candidates,
+                                        const std::size_t max) {
+  std::lock_guard<std::mutex> guard(latch);
+  candidates.clear();
+  // unreferenced cold pages in the order the cold hand reaches them, then the hot pages the hot
+  // hand would demote next
+  for (std::uint32_t i = 1; i <= capacity && candidates.size() < max; i++) {
+    const FrameId frame = (coldHand + i) % capacity;
+    if (frames[frame].status == COLD && !frames[frame].pinned &&
+        !referenced[frame].load(std::memory_order_relaxed)) {
+      candidates.push_back(frame);
+    }
+  }
+  for (std::uint32_t i = 1; i <= capacity && candidates.size() < max; i++) {
+    const FrameId frame = (hotHand + i) % capacity;
+    if (frames[frame].status == HOT && !frames[frame].pinned &&
+        !referenced[frame].load(std::memory_order_relaxed)) {
+      candidates.push_back(frame);
+    }
+  }
+}
+
+void ClockProPolicy::resize(const std::uint32_t numBufs) {
+  std::lock_guard<std::mutex> guard(latch);
+  const std::uint32_t oldBufs = capacity;
+  // frames being released are empty and pinned, so only stale free list entries can name them
+  freeFrames.erase(std::remove_if(freeFrames.begin(), freeFrames.end(),
+                                  [numBufs](const FrameId frame) { return frame >= numBufs; }),
+                   freeFrames.end());
+  FrameState empty;
+  empty.status = EMPTY;
+  empty.inTest = false;
+  empty.pinned = false;
+  frames.resize(numBufs, empty);
+  listedFree.resize(numBufs, false);
+  capacity = numBufs;
+  coldHand %= capacity;
+  hotHand %= capacity;
+  if (coldTarget > capacity - 1) {
+    coldTarget = capacity > 1 ? capacity - 1 : 1;
+  }
+  while (nonResident.size() > capacity && nonResident.popBack()) {
+  }
+  for (FrameId i = numBufs; i > oldBufs; i--) {
+    referenced[i - 1].store(false, std::memory_order_relaxed);
+    pushFree(i - 1);
+  }
+}
+
+}
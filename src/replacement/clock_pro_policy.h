@@ -0,0 +1,153 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "ghost_list.h"
+#include "replacement_policy.h"
+
+namespace badgerdb {
+
+/**
+ * @brief CLOCK-Pro (Jiang, Chen and Zhang) over the frames of the pool.
+ *
+ * Resident pages are hot or cold. New pages start cold and in their test period. The cold hand
+ * evicts unreferenced cold pages; a cold page referenced during its test period is promoted to
+ * hot. Evicted cold pages still in their test period are remembered as non-resident ghosts, and a
+ * miss on one of them also makes the page hot and grows the share of frames given to cold pages.
+ * Ghosts that age out unreferenced shrink that share. The hot hand demotes unreferenced hot pages
+ * to cold whenever there are more hot pages than the share allows.
+ *
+ * The clock order is the frame order, and the non-resident pages are kept in a bounded FIFO
+ * rather than on the clock, which is what the test hand would otherwise sweep. Reference bits
+ * are atomics outside the latch, so a hit, which only sets one, takes no latch.
+ */
+class ClockProPolicy : public ReplacementPolicy {
+ public:
+  /**
+   * Constructor of ClockProPolicy class
+   *
+   * @param numBufs   Number of frames in the buffer pool
+   * @param maxBufs   Most frames the pool will ever be resized to; numBufs if smaller
+   */
+  explicit ClockProPolicy(const std::uint32_t numBufs, const std::uint32_t maxBufs = 0);
+
+  /**
+   * Destructor of ClockProPolicy class
+   */
+  ~ClockProPolicy();
+
+  void accessed(const FrameId frame) override;
+  void loaded(const FrameId frame, const File* file, const PageId pageNo) override;
+  void pinned(const FrameId frame) override;
+  void unpinned(const FrameId frame) override;
+  void evicted(const FrameId frame, const FileId fileId, const PageId pageNo) override;
+  void freed(const FrameId frame) override;
+  bool pickVictim(FrameId& frame) override;
+  void evictionCandidates(std::vector<FrameId>& candidates, const std::size_t max) override;
+  void resize(const std::uint32_t numBufs) override;
+  std::uint32_t lastSweepSteps() const override;
+
+ private:
+  /**
+   * Status of the page in a frame
+   */
+  enum Status { EMPTY, COLD, HOT };
+
+  /**
+   * Per frame state
+   */
+  struct FrameState {
+    Status status;
+    bool inTest;
+    bool pinned;
+  };
+
+  /**
+   * Adds frame to freeFrames unless it is already there.
+   */
+  void pushFree(const FrameId frame);
+
+  /**
+   * Runs the hot hand until it demotes one hot page to cold.
+   *
+   * @return  False if no unpinned hot page could be demoted
+   */
+  bool runHotHand();
+
+  /**
+   * Runs the hot hand while there are more hot pages than the hot share allows.
+   */
+  void balanceHot();
+
+  /**
+   * Number of frames in the buffer pool
+   */
+  std::uint32_t capacity;
+
+  /**
+   * Target number of cold resident pages, adapted by test period outcomes
+   */
+  std::uint32_t coldTarget;
+
+  /**
+   * Number of resident hot pages
+   */
+  std::uint32_t hotCount;
+
+  /**
+   * Position of the cold hand
+   */
+  FrameId coldHand;
+
+  /**
+   * Frames the cold hand moved past during the last pickVictim()
+   */
+  std::uint32_t sweepSteps;
+
+  /**
+   * Position of the hot hand
+   */
+  FrameId hotHand;
+
+  /**
+   * State of every frame
+   */
+  std::vector<FrameState> frames;
+
+  /**
+   * Evicted cold pages still in their test period, newest first
+   */
+  GhostList nonResident;
+
+  /**
+   * Empty frames. Entries that have since been pinned or loaded are skipped.
+   */
+  std::vector<FrameId> freeFrames;
+
+  /**
+   * True while the frame has an entry in freeFrames
+   */
+  std::vector<bool> listedFree;
+
+  /**
+   * Guards all of the above
+   */
+  std::mutex latch;
+
+  /**
+   * Has the page in this frame been referenced since a hand last passed it. Allocated for the
+   * largest size the pool can grow to, since accessed() sets it without the latch.
+   */
+  std::atomic<bool>* referenced;
+};
+
+}
@@ -0,0 +1,91 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <map>
+
+#include "replacement_policy.h"
+
+namespace badgerdb {
+
+/**
+ * @brief Ordered list of pages that are no longer resident, newest at the front.
+ *
+ * @warning This class is not threadsafe.
+ */
+class GhostList {
+ public:
+  /**
+   * Returns true if key is in the list.
+   */
+  bool contains(const GhostKey& key) const {
+    return positions_.find(key) != positions_.end();
+  }
+
+  /**
+   * Removes key from the list.
+   *
+   * @return  True if key was in the list.
+   */
+  bool erase(const GhostKey& key) {
+    std::map<GhostKey, std::list<GhostKey>::iterator>::iterator pos = positions_.find(key);
+    if (pos == positions_.end()) {
+      return false;
+    }
+    keys_.erase(pos->second);
+    positions_.erase(pos);
+    return true;
+  }
+
+  /**
+   * Adds key as the newest entry, moving it there if it is already present.
+   */
+  void pushFront(const GhostKey& key) {
+    erase(key);
+    keys_.push_front(key);
+    positions_[key] = keys_.begin();
+  }
+
+  /**
+   * Removes the oldest entry.
+   *
+   * @param dropped   If not NULL, receives the removed key
+   * @return  False if the list is empty.
+   */
+  bool popBack(GhostKey* dropped = NULL) {
+    if (keys_.empty()) {
+      return false;
+    }
+    if (dropped != NULL) {
+      *dropped = keys_.back();
+    }
+    positions_.erase(keys_.back());
+    keys_.pop_back();
+    return true;
+  }
+
+  /**
+   * Returns the number of entries.
+   */
+  std::size_t size() const { return keys_.size(); }
+
+ private:
+  /**
+   * Keys, newest first.
+   */
+  std::list<GhostKey> keys_;
+
+  /**
+   * Position of every key in keys_.
+   */
+  std::map<GhostKey, std::list<GhostKey>::iterator> positions_;
+};
+
+}
@@ -0,0 +1,166 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "lru_k_policy.h"
+
+#include <algorithm>
+
+#include "file.h"
+
+namespace badgerdb {
+
+LruKPolicy::LruKPolicy(const std::uint32_t numBufs, const std::uint32_t kIn)
+    : k(kIn),
+      now(0),
+      history(numBufs * kIn, 0),
+      pinnedFrames(numBufs, false),
+      residentFrames(numBufs, false),
+      listedFree(numBufs, false) {
+  for (FrameId i = numBufs; i > 0; i--) {
+    pushFree(i - 1);
+  }
+}
+
+LruKPolicy::Candidate LruKPolicy::candidateOf(const FrameId frame) const {
+  return Candidate(std::make_pair(history[frame * k + k - 1], history[frame * k]), frame);
+}
+
+void LruKPolicy::recordReference(const FrameId frame) {
+  std::uint64_t* times = &history[frame * k];
+  for (std::uint32_t i = k - 1; i > 0; i--) {
+    times[i] = times[i - 1];
+  }
+  times[0] = ++now;
+}
+
+void LruKPolicy::pushFree(const FrameId frame) {
+  if (!listedFree[frame]) {
+    listedFree[frame] = true;
+    freeFrames.push_back(frame);
+  }
+}
+
+void LruKPolicy::accessed(const FrameId frame) {
+  if (accesses.record(frame)) {
+    std::lock_guard<std::mutex> guard(latch);
+    applyAccesses();
+  }
+}
+
+void LruKPolicy::hit(const FrameId frame) {
+  const bool wasEvictable = evictable.erase(candidateOf(frame)) > 0;
+  recordReference(frame);
+  if (wasEvictable) {
+    evictable.insert(candidateOf(frame));
+  }
+}
+
+void LruKPolicy::applyAccesses() {
+  accesses.drain([this](const FrameId frame) { hit(frame); });
+}
+
+void LruKPolicy::loaded(const FrameId frame, const File* file, const PageId pageNo) {
+  std::lock_guard<std::mutex> guard(latch);
+  const GhostKey key(file->id(), pageNo);
+  std::map<GhostKey, std::vector<std::uint64_t> >::iterator kept = retainedHistory.find(key);
+  if (kept != retainedHistory.end()) {
+    std::copy(kept->second.begin(), kept->second.end(), history.begin() + frame * k);
+    retainedHistory.erase(kept);
+    retained.erase(key);
+  } else {
+    std::fill(history.begin() + frame * k, history.begin() + (frame + 1) * k, 0);
+  }
+  recordReference(frame);
+  residentFrames[frame] = true;
+}
+
+void LruKPolicy::pinned(const FrameId frame) {
+  std::lock_guard<std::mutex> guard(latch);
+  pinnedFrames[frame] = true;
+  evictable.erase(candidateOf(frame));
+}
+
+void LruKPolicy::unpinned(const FrameId frame) {
+  std::lock_guard<std::mutex> guard(latch);
+  pinnedFrames[frame] = false;
+  if (residentFrames[frame]) {
+    evictable.insert(candidateOf(frame));
+  } else {
+    pushFree(frame);
+  }
+}
+
+void LruKPolicy::evicted(const FrameId frame, const FileId fileId, const PageId pageNo) {
+  std::lock_guard<std::mutex> guard(latch);
+  const GhostKey key(fileId, pageNo);
+  evictable.erase(candidateOf(frame));
+  residentFrames[frame] = false;
+
+  retainedHistory[key].assign(history.begin() + frame * k, history.begin() + (frame + 1) * k);
+  retained.pushFront(key);
+  GhostKey dropped;
+  while (retained.size() > residentFrames.size() && retained.popBack(&dropped)) {
+    retainedHistory.erase(dropped);
+  }
+}
+
+void LruKPolicy::freed(const FrameId frame) {
+  std::lock_guard<std::mutex> guard(latch);
+  evictable.erase(candidateOf(frame));
+  residentFrames[frame] = false;
+  if (!pinnedFrames[frame]) {
+    pushFree(frame);
+  }
+}
+
+bool LruKPolicy::pickVictim(FrameId& frame) {
+  std::lock_guard<std::mutex> guard(latch);
+  applyAccesses();
+  while (!freeFrames.empty()) {
+    const FrameId candidate = freeFrames.back();
+    if (!pinnedFrames[candidate] && !residentFrames[candidate]) {
+      frame = candidate;
+      return true;
+    }
+    freeFrames.pop_back();
+    listedFree[candidate] = false;
+  }
+  if (evictable.empty()) {
+    return false;
+  }
+  frame = evictable.begin()->second;
+  return true;
+}
+
+void LruKPolicy::evictionCandidates(std::vector<FrameId>& frames, const std::size_t max) {
+  std::lock_guard<std::mutex> guard(latch);
+  applyAccesses();
+  frames.clear();
+  for (std::set<Candidate>::const_iterator it = evictable.begin();
+       it != evictable.end() && frames.size() < max; ++it) {
+    frames.push_back(it->second);
+  }
+}
+
+void LruKPolicy::resize(const std::uint32_t numBufs) {
+  std::lock_guard<std::mutex> guard(latch);
+  applyAccesses();
+  const std::uint32_t oldBufs = residentFrames.size();
+  // frames being released are empty and pinned, so only stale free list entries can name them
+  freeFrames.erase(std::remove_if(freeFrames.begin(), freeFrames.end(),
+                                  [numBufs](const FrameId frame) { return frame >= numBufs; }),
+                   freeFrames.end());
+  history.resize(static_cast<std::size_t>(numBufs) * k, 0);
+  pinnedFrames.resize(numBufs, false);
+  residentFrames.resize(numBufs, false);
+  listedFree.resize(numBufs, false);
+  for (FrameId i = numBufs; i > oldBufs; i--) {
+    pushFree(i - 1);
+  }
+}
+
+}
@@ -0,0 +1,142 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include "access_log.h"
+#include "ghost_list.h"
+#include "replacement_policy.h"
+
+namespace badgerdb {
+
+/**
+ * @brief LRU-K: evicts the unpinned page whose K-th most recent reference is oldest.
+ *
+ * Pages referenced fewer than K times have an infinite backward K-distance and go first, oldest
+ * last reference first. Reference history of evicted pages is retained for as many pages as
+ * there are frames, so a page that comes back soon keeps its earlier references.
+ *
+ * Hits are stamped when their batch is applied rather than when they happen; see AccessLog.
+ */
+class LruKPolicy : public ReplacementPolicy {
+ public:
+  /**
+   * Constructor of LruKPolicy class
+   *
+   * @param numBufs   Number of frames in the buffer pool
+   * @param k         Number of references remembered per page
+   */
+  explicit LruKPolicy(const std::uint32_t numBufs, const std::uint32_t k = 2);
+
+  void accessed(const FrameId frame) override;
+  void loaded(const FrameId frame, const File* file, const PageId pageNo) override;
+  void pinned(const FrameId frame) override;
+  void unpinned(const FrameId frame) override;
+  void evicted(const FrameId frame, const FileId fileId, const PageId pageNo) override;
+  void freed(const FrameId frame) override;
+  bool pickVictim(FrameId& frame) override;
+  void evictionCandidates(std::vector<FrameId>& frames, const std::size_t max) override;
+  void resize(const std::uint32_t numBufs) override;
+
+ private:
+  /**
+   * Ordering key of an evictable frame: (K-th most recent reference, most recent reference).
+   */
+  typedef std::pair<std::pair<std::uint64_t, std::uint64_t>, FrameId> Candidate;
+
+  /**
+   * Returns the ordering key of frame from its current history.
+   */
+  Candidate candidateOf(const FrameId frame) const;
+
+  /**
+   * Applies a hit on frame to the order. Caller holds latch.
+   */
+  void hit(const FrameId frame);
+
+  /**
+   * Applies every hit recorded in accesses. Caller holds latch.
+   */
+  void applyAccesses();
+
+  /**
+   * Shifts a new reference into the history of frame.
+   */
+  void recordReference(const FrameId frame);
+
+  /**
+   * Adds frame to freeFrames unless it is already there.
+   */
+  void pushFree(const FrameId frame);
+
+  /**
+   * Number of references remembered per page
+   */
+  std::uint32_t k;
+
+  /**
+   * Logical time, advanced on every reference
+   */
+  std::uint64_t now;
+
+  /**
+   * Reference times of the page in each frame, most recent first, k per frame. Zero means none.
+   */
+  std::vector<std::uint64_t> history;
+
+  /**
+   * True while the frame's pin count is above zero
+   */
+  std::vector<bool> pinnedFrames;
+
+  /**
+   * True while the frame holds a page
+   */
+  std::vector<bool> residentFrames;
+
+  /**
+   * Unpinned resident frames in eviction order
+   */
+  std::set<Candidate> evictable;
+
+  /**
+   * Empty frames. Entries that have since been pinned or loaded are skipped.
+   */
+  std::vector<FrameId> freeFrames;
+
+  /**
+   * True while the frame has an entry in freeFrames
+   */
+  std::vector<bool> listedFree;
+
+  /**
+   * Evicted pages whose history is retained, newest first
+   */
+  GhostList retained;
+
+  /**
+   * History of every page in retained
+   */
+  std::map<GhostKey, std::vector<std::uint64_t> > retainedHistory;
+
+  /**
+   * Guards all of the above
+   */
+  std::mutex latch;
+
+  /**
+   * Hits on resident frames not yet applied, recorded by accessed() without taking latch
+   */
+  AccessLog accesses;
+};
+
+}
@@ -0,0 +1,154 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "types.h"
+
+namespace badgerdb {
+
+class File;
+
+/**
+ * @brief Replacement policies BufMgr can be constructed with.
+ */
+enum class ReplacementPolicyType {
+  CLOCK,      /**< Single reference bit clock */
+  LRU_K,      /**< LRU-2: evict the page whose second most recent reference is oldest */
+  TWO_Q,      /**< Full 2Q with A1in, A1out and Am queues */
+  ARC,        /**< Adaptive Replacement Cache */
+  CLOCK_PRO   /**< CLOCK-Pro with hot, cold and test clock hands */
+};
+
+/**
+ * @brief Identity of a page that has left the buffer pool, remembered by policies that keep
+ *        history of non-resident pages.  Keyed by the file's ID rather than a File object, so
+ *        the history survives the object and never matches a later file at the same address.
+ */
+typedef std::pair<FileId, PageId> GhostKey;
+
+/**
+ * @brief Interface through which BufMgr delegates the choice of victim frames.
+ *
+ * A policy starts out with every frame empty. BufMgr reports every change of a frame's state
+ * through the hooks below, calling pinned() when a frame's pin count leaves zero and unpinned()
+ * when it returns to zero while holding that frame's descriptor latch, so the policy's view of
+ * which frames are pinned matches the descriptors.  A frame whose page is STICKY counts as pinned
+ * whatever its pin count, and is reported as such when it becomes or stops being sticky.  Hooks may be called from many threads at
+ * once; pickVictim() is only ever called by one thread at a time.
+ */
+class ReplacementPolicy {
+ public:
+  /**
+   * Creates a policy of the given type for a pool of numBufs frames.
+   *
+   * @param type      Policy to create
+   * @param numBufs   Number of frames in the buffer pool
+   * @param maxBufs   Most frames the pool will ever be resized to
+   * @return  Newly allocated policy, owned by the caller
+   */
+  static ReplacementPolicy* create(const ReplacementPolicyType type,
+                                   const std::uint32_t numBufs,
+                                   const std::uint32_t maxBufs);
+
+  /**
+   * Destructor of ReplacementPolicy class
+   */
+  virtual ~ReplacementPolicy() {}
+
+  /**
+   * Resident page in frame was requested again. Called on every hit, from many threads at once,
+   * so it should not take a latch every other hook takes.
+   *
+   * @param frame   Frame holding the page
+   */
+  virtual void accessed(const FrameId frame) = 0;
+
+  /**
+   * Page was read or allocated into frame, which is pinned.
+   *
+   * @param frame   Frame now holding the page
+   * @param file    File of the page
+   * @param pageNo  Page number in the file
+   */
+  virtual void loaded(const FrameId frame, const File* file, const PageId pageNo) = 0;
+
+  /**
+   * Pin count of frame went from zero to one. The frame must not be picked as a victim.
+   *
+   * @param frame   Frame that was pinned
+   */
+  virtual void pinned(const FrameId frame) = 0;
+
+  /**
+   * Pin count of frame went back to zero.
+   *
+   * @param frame   Frame that was unpinned
+   */
+  virtual void unpinned(const FrameId frame) = 0;
+
+  /**
+   * Page in frame was replaced after frame was picked as a victim. The frame stays pinned until
+   * the new page is loaded.  The page is named by its file's ID, as the handle it was loaded
+   * through may be gone by now.
+   *
+   * @param frame   Frame that held the page
+   * @param fileId  ID of the file of the page
+   * @param pageNo  Page number in the file
+   */
+  virtual void evicted(const FrameId frame, const FileId fileId, const PageId pageNo) = 0;
+
+  /**
+   * Frame was emptied without being picked as a victim, for example by flushFile() or
+   * disposePage(). Policies should hand it out again before evicting anything.
+   *
+   * @param frame   Frame that is now empty
+   */
+  virtual void freed(const FrameId frame) = 0;
+
+  /**
+   * Chooses the next frame to hand out: an empty frame if the policy knows of one, otherwise an
+   * unpinned resident frame.
+   *
+   * @param frame   Chosen frame is returned via this variable
+   * @return  False if every frame is pinned
+   */
+  virtual bool pickVictim(FrameId& frame) = 0;
+
+  /**
+   * Lists unpinned resident frames in roughly the order the policy would pick them as victims,
+   * so their dirty pages can be written back before they are needed. Does not change any state.
+   *
+   * @param frames    Cleared, then filled with at most max frames
+   * @param max       Number of frames wanted
+   */
+  virtual void evictionCandidates(std::vector<FrameId>& frames, const std::size_t max) = 0;
+
+  /**
+   * Number of frames a clock hand moved past during the last pickVictim() call, for statistics.
+   * Called with victim selection held off, like pickVictim().
+   *
+   * @return  Zero for policies without a clock hand
+   */
+  virtual std::uint32_t lastSweepSteps() const { return 0; }
+
+  /**
+   * The pool now has numBufs frames. Frames added by growing start out empty. Before shrinking,
+   * BufMgr empties and pins every frame being released, and never mentions them to the policy
+   * again. Called with victim selection held off, like pickVictim().
+   *
+   * @param numBufs   New number of frames, at most the maxBufs the policy was created with
+   */
+  virtual void resize(const std::uint32_t numBufs) = 0;
+};
+
+}
@@ -0,0 +1,178 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "two_q_policy.h"
+
+#include <algorithm>
+
+#include "file.h"
+
+namespace badgerdb {
+
+TwoQPolicy::TwoQPolicy(const std::uint32_t numBufs)
+    : kin(numBufs / 4 > 0 ? numBufs / 4 : 1),
+      kout(numBufs / 2 > 0 ? numBufs / 2 : 1),
+      queueOf(numBufs, NONE),
+      positions(numBufs),
+      pinnedFrames(numBufs, false),
+      listedFree(numBufs, false) {
+  for (FrameId i = numBufs; i > 0; i--) {
+    pushFree(i - 1);
+  }
+}
+
+void TwoQPolicy::unlink(const FrameId frame) {
+  if (queueOf[frame] == A1IN) {
+    a1in.erase(positions[frame]);
+  } else if (queueOf[frame] == AM) {
+    am.erase(positions[frame]);
+  }
+  queueOf[frame] = NONE;
+}
+
+void TwoQPolicy::pushFree(const FrameId frame) {
+  if (!listedFree[frame]) {
+    listedFree[frame] = true;
+    freeFrames.push_back(frame);
+  }
+}
+
+bool TwoQPolicy::oldestUnpinned(const std::list<FrameId>& queue, FrameId& frame) const {
+  for (std::list<FrameId>::const_reverse_iterator it = queue.rbegin(); it != queue.rend(); ++it) {
+    if (!pinnedFrames[*it]) {
+      frame = *it;
+      return true;
+    }
+  }
+  return false;
+}
+
+void TwoQPolicy::appendUnpinned(const std::list<FrameId>& queue, std::vector<FrameId>& frames,
+                                const std::size_t max) const {
+  for (std::list<FrameId>::const_reverse_iterator it = queue.rbegin();
+       it != queue.rend() && frames.size() < max; ++it) {
+    if (!pinnedFrames[*it]) {
+      frames.push_back(*it);
+    }
+  }
+}
+
+void TwoQPolicy::accessed(const FrameId frame) {
+  if (accesses.record(frame)) {
+    std::lock_guard<std::mutex> guard(latch);
+    applyAccesses();
+  }
+}
+
+void TwoQPolicy::hit(const FrameId frame) {
+  // a hit while in A1in is treated as correlated with the first reference and changes nothing
+  if (queueOf[frame] == AM) {
+    am.splice(am.begin(), am, positions[frame]);
+  }
+}
+
+void TwoQPolicy::applyAccesses() {
+  accesses.drain([this](const FrameId frame) { hit(frame); });
+}
+
+void TwoQPolicy::loaded(const FrameId frame, const File* file, const PageId pageNo) {
+  std::lock_guard<std::mutex> guard(latch);
+  unlink(frame);
+  if (a1out.erase(GhostKey(file->id(), pageNo))) {
+    am.push_front(frame);
+    positions[frame] = am.begin();
+    queueOf[frame] = AM;
+  } else {
+    a1in.push_front(frame);
+    positions[frame] = a1in.begin();
+    queueOf[frame] = A1IN;
+  }
+}
+
+void TwoQPolicy::pinned(const FrameId frame) {
+  std::lock_guard<std::mutex> guard(latch);
+  pinnedFrames[frame] = true;
+}
+
+void TwoQPolicy::unpinned(const FrameId frame) {
+  std::lock_guard<std::mutex> guard(latch);
+  pinnedFrames[frame] = false;
+  if (queueOf[frame] == NONE) {
+    pushFree(frame);
+  }
+}
+
+void TwoQPolicy::evicted(const FrameId frame, const FileId fileId, const PageId pageNo) {
+  std::lock_guard<std::mutex> guard(latch);
+  if (queueOf[frame] == A1IN) {
+    a1out.pushFront(GhostKey(fileId, pageNo));
+    while (a1out.size() > kout) {
+      a1out.popBack();
+    }
+  }
+  unlink(frame);
+}
+
+void TwoQPolicy::freed(const FrameId frame) {
+  std::lock_guard<std::mutex> guard(latch);
+  unlink(frame);
+  if (!pinnedFrames[frame]) {
+    pushFree(frame);
+  }
+}
+
+bool TwoQPolicy::pickVictim(FrameId& frame) {
+  std::lock_guard<std::mutex> guard(latch);
+  applyAccesses();
+  while (!freeFrames.empty()) {
+    const FrameId candidate = freeFrames.back();
+    if (!pinnedFrames[candidate] && queueOf[candidate] == NONE) {
+      frame = candidate;
+      return true;
+    }
+    freeFrames.pop_back();
+    listedFree[candidate] = false;
+  }
+
+  if (a1in.size() > kin && oldestUnpinned(a1in, frame)) {
+    return true;
+  }
+  return oldestUnpinned(am, frame) || oldestUnpinned(a1in, frame);
+}
+
+void TwoQPolicy::evictionCandidates(std::vector<FrameId>& frames, const std::size_t max) {
+  std::lock_guard<std::mutex> guard(latch);
+  applyAccesses();
+  frames.clear();
+  const bool a1inFirst = a1in.size() > kin;
+  appendUnpinned(a1inFirst ? a1in : am, frames, max);
+  appendUnpinned(a1inFirst ? am : a1in, frames, max);
+}
+
+void TwoQPolicy::resize(const std::uint32_t numBufs) {
+  std::lock_guard<std::mutex> guard(latch);
+  applyAccesses();
+  const std::uint32_t oldBufs = queueOf.size();
+  // frames being released are empty and pinned, so only stale free list entries can name them
+  freeFrames.erase(std::remove_if(freeFrames.begin(), freeFrames.end(),
+                                  [numBufs](const FrameId frame) { return frame >= numBufs; }),
+                   freeFrames.end());
+  queueOf.resize(numBufs, NONE);
+  positions.resize(numBufs);
+  pinnedFrames.resize(numBufs, false);
+  listedFree.resize(numBufs, false);
+  kin = numBufs / 4 > 0 ? numBufs / 4 : 1;
+  kout = numBufs / 2 > 0 ? numBufs / 2 : 1;
+  while (a1out.size() > kout) {
+    a1out.popBack();
+  }
+  for (FrameId i = numBufs; i > oldBufs; i--) {
+    pushFree(i - 1);
+  }
+}
+
+}
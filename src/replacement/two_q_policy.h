@@ -0,0 +1,150 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <list>
+#include <mutex>
+#include <vector>
+
+#include "access_log.h"
+#include "ghost_list.h"
+#include "replacement_policy.h"
+
+namespace badgerdb {
+
+/**
+ * @brief Full 2Q (Johnson and Shasha).
+ *
+ * Pages seen for the first time enter the A1in FIFO. When A1in is over its share of the pool its
+ * oldest page is evicted and remembered in the A1out ghost queue. A page that misses while in
+ * A1out has been referenced twice within a short span, so it goes straight to the Am LRU list,
+ * which only loses pages once A1in is within its share. A one-off scan therefore only cycles
+ * through A1in and leaves Am alone.
+ *
+ * Hits move pages up Am in batches, through an AccessLog, rather than one at a time.
+ */
+class TwoQPolicy : public ReplacementPolicy {
+ public:
+  /**
+   * Constructor of TwoQPolicy class
+   *
+   * @param numBufs   Number of frames in the buffer pool
+   */
+  explicit TwoQPolicy(const std::uint32_t numBufs);
+
+  void accessed(const FrameId frame) override;
+  void loaded(const FrameId frame, const File* file, const PageId pageNo) override;
+  void pinned(const FrameId frame) override;
+  void unpinned(const FrameId frame) override;
+  void evicted(const FrameId frame, const FileId fileId, const PageId pageNo) override;
+  void freed(const FrameId frame) override;
+  bool pickVictim(FrameId& frame) override;
+  void evictionCandidates(std::vector<FrameId>& frames, const std::size_t max) override;
+  void resize(const std::uint32_t numBufs) override;
+
+ private:
+  /**
+   * Queue a resident frame is on
+   */
+  enum Queue { NONE, A1IN, AM };
+
+  /**
+   * Takes frame off the queue it is on.
+   */
+  void unlink(const FrameId frame);
+
+  /**
+   * Applies a hit on frame to the order. Caller holds latch.
+   */
+  void hit(const FrameId frame);
+
+  /**
+   * Applies every hit recorded in accesses. Caller holds latch.
+   */
+  void applyAccesses();
+
+  /**
+   * Adds frame to freeFrames unless it is already there.
+   */
+  void pushFree(const FrameId frame);
+
+  /**
+   * Finds the oldest unpinned frame of a queue.
+   *
+   * @return  False if every frame on the queue is pinned
+   */
+  bool oldestUnpinned(const std::list<FrameId>& queue, FrameId& frame) const;
+
+  /**
+   * Appends the unpinned frames of a queue, oldest first, until frames holds max entries.
+   */
+  void appendUnpinned(const std::list<FrameId>& queue, std::vector<FrameId>& frames,
+                      const std::size_t max) const;
+
+  /**
+   * Target size of A1in, a quarter of the pool
+   */
+  std::size_t kin;
+
+  /**
+   * Size of A1out, half the pool
+   */
+  std::size_t kout;
+
+  /**
+   * First-time pages, newest first
+   */
+  std::list<FrameId> a1in;
+
+  /**
+   * Pages referenced again, most recently used first
+   */
+  std::list<FrameId> am;
+
+  /**
+   * Pages evicted from A1in, newest first
+   */
+  GhostList a1out;
+
+  /**
+   * Queue each frame is on
+   */
+  std::vector<Queue> queueOf;
+
+  /**
+   * Position of each queued frame on its queue
+   */
+  std::vector<std::list<FrameId>::iterator> positions;
+
+  /**
+   * True while the frame's pin count is above zero
+   */
+  std::vector<bool> pinnedFrames;
+
+  /**
+   * Empty frames. Entries that have since been pinned or loaded are skipped.
+   */
+  std::vector<FrameId> freeFrames;
+
+  /**
+   * True while the frame has an entry in freeFrames
+   */
+  std::vector<bool> listedFree;
+
+  /**
+   * Guards all of the above
+   */
+  std::mutex latch;
+
+  /**
+   * Hits on resident frames not yet applied, recorded by accessed() without taking latch
+   */
+  AccessLog accesses;
+};
+
+}
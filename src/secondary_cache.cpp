@@ -0,0 +1,319 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "secondary_cache.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "page.h"
+#include "exceptions/secondary_cache_exception.h"
+
+namespace badgerdb {
+
+namespace {
+
+/**
+ * Bytes at the start of the cache file describing its layout
+ */
+const std::size_t SUPERBLOCK_SIZE = 4096;
+
+/**
+ * Bytes of header in front of the page in each slot
+ */
+const std::size_t SLOT_HEADER_SIZE = 256;
+
+const std::size_t SLOT_SIZE = SLOT_HEADER_SIZE + Page::SIZE;
+
+const char SUPERBLOCK_MAGIC[8] = {'b', 'd', 'b', 'c', 'a', 'c', 'h', '1'};
+
+/**
+ * Marks a slot header as holding a page
+ */
+const std::uint32_t SLOT_MAGIC = 0x42444243;
+
+struct Superblock {
+  char magic[8];
+  std::uint64_t slotSize;
+  std::uint64_t numSlots;
+};
+
+struct SlotHeader {
+  std::uint32_t magic;
+  std::uint32_t pageNo;
+  std::uint64_t checksum;
+  std::uint32_t nameLength;
+  std::uint32_t reserved;
+  char name[SLOT_HEADER_SIZE - 24];
+};
+
+static_assert(sizeof(SlotHeader) == SLOT_HEADER_SIZE, "slot header must fill its space exactly");
+
+/**
+ * FNV-1a hash of a page, to catch slots torn by a crash mid-write
+ */
+std::uint64_t checksum(const char* bytes) {
+  std::uint64_t hash = 14695981039346656037ULL;
+  for (std::size_t i = 0; i < Page::SIZE; i++) {
+    hash ^= static_cast<unsigned char>(bytes[i]);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+bool readFully(const int fd, char* bytes, std::size_t length, off_t offset) {
+  while (length > 0) {
+    const ssize_t n = ::pread(fd, bytes, length, offset);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    bytes += n;
+    length -= n;
+    offset += n;
+  }
+  return true;
+}
+
+bool writeFully(const int fd, const char* bytes, std::size_t length, off_t offset) {
+  while (length > 0) {
+    const ssize_t n = ::pwrite(fd, bytes, length, offset);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    bytes += n;
+    length -= n;
+    offset += n;
+  }
+  return true;
+}
+
+}
+
+SecondaryCache::SecondaryCache(const std::string& pathIn, const std::size_t numSlots)
+    : path(pathIn), fd(-1), slots(numSlots), hand(0) {
+  if (numSlots == 0) {
+    throw SecondaryCacheException(path, "must hold at least one page");
+  }
+  fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd < 0) {
+    throw SecondaryCacheException(path, std::strerror(errno));
+  }
+  for (std::size_t i = 0; i < numSlots; i++) {
+    slots[i].used = false;
+    slots[i].busy = false;
+  }
+
+  Superblock super;
+  const bool reusable = readFully(fd, reinterpret_cast<char*>(&super), sizeof(super), 0) &&
+      std::memcmp(super.magic, SUPERBLOCK_MAGIC, sizeof(super.magic)) == 0 &&
+      super.slotSize == SLOT_SIZE && super.numSlots == numSlots;
+  if (reusable) {
+    // rebuild the index from the slot headers; a slot with a bad page is found out on take
+    for (std::size_t i = 0; i < numSlots; i++) {
+      SlotHeader header;
+      if (!readFully(fd, reinterpret_cast<char*>(&header), sizeof(header), slotOffset(i)) ||
+          header.magic != SLOT_MAGIC || header.nameLength > sizeof(header.name)) {
+        continue;
+      }
+      const Key key(std::string(header.name, header.nameLength), header.pageNo);
+      if (index.insert(std::make_pair(key, i)).second) {
+        slots[i].used = true;
+        slots[i].key = key;
+      }
+    }
+  } else {
+    // start over: an empty file of the right size, with every slot header zeroed
+    std::memset(&super, 0, sizeof(super));
+    std::memcpy(super.magic, SUPERBLOCK_MAGIC, sizeof(super.magic));
+    super.slotSize = SLOT_SIZE;
+    super.numSlots = numSlots;
+    if (::ftruncate(fd, 0) != 0 || ::ftruncate(fd, slotOffset(numSlots)) != 0 ||
+        !writeFully(fd, reinterpret_cast<const char*>(&super), sizeof(super), 0)) {
+      const std::string reason = std::strerror(errno);
+      ::close(fd);
+      throw SecondaryCacheException(path, reason);
+    }
+  }
+
+  // free slots are handed out lowest first
+  for (std::size_t i = numSlots; i > 0; i--) {
+    if (!slots[i - 1].used) {
+      freeSlots.push_back(i - 1);
+    }
+  }
+}
+
+SecondaryCache::~SecondaryCache() {
+  ::close(fd);
+}
+
+off_t SecondaryCache::slotOffset(const std::size_t slot) {
+  return static_cast<off_t>(SUPERBLOCK_SIZE + slot * SLOT_SIZE);
+}
+
+bool SecondaryCache::claimSlot(std::size_t& slot) {
+  if (!freeSlots.empty()) {
+    slot = freeSlots.back();
+    freeSlots.pop_back();
+    return true;
+  }
+  for (std::size_t i = 0; i < slots.size(); i++) {
+    const std::size_t candidate = hand;
+    hand = (hand + 1) % slots.size();
+    if (!slots[candidate].busy) {
+      index.erase(slots[candidate].key);
+      slots[candidate].used = false;
+      slot = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+void SecondaryCache::releaseSlot(const std::size_t slot) {
+  // a failed write leaves the old header, which take rejects by name, page number or checksum
+  const std::uint32_t empty = 0;
+  writeFully(fd, reinterpret_cast<const char*>(&empty), sizeof(empty), slotOffset(slot));
+
+  std::lock_guard<std::mutex> guard(latch);
+  slots[slot].busy = false;
+  freeSlots.push_back(slot);
+}
+
+void SecondaryCache::put(const std::string& fileName, const PageId pageNo, const char* bytes) {
+  std::vector<char> buffer(SLOT_SIZE, 0);
+  SlotHeader* header = reinterpret_cast<SlotHeader*>(buffer.data());
+  if (fileName.size() > sizeof(header->name)) {
+    return;
+  }
+  header->magic = SLOT_MAGIC;
+  header->pageNo = pageNo;
+  header->checksum = checksum(bytes);
+  header->nameLength = static_cast<std::uint32_t>(fileName.size());
+  std::memcpy(header->name, fileName.data(), fileName.size());
+  std::memcpy(buffer.data() + SLOT_HEADER_SIZE, bytes, Page::SIZE);
+
+  const Key key(fileName, pageNo);
+  std::size_t slot;
+  {
+    std::lock_guard<std::mutex> guard(latch);
+    // an older copy is overwritten in place
+    std::map<Key, std::size_t>::iterator it = index.find(key);
+    if (it != index.end()) {
+      slot = it->second;
+      index.erase(it);
+      slots[slot].used = false;
+    } else if (!claimSlot(slot)) {
+      return;
+    }
+    slots[slot].busy = true;
+  }
+
+  if (!writeFully(fd, buffer.data(), buffer.size(), slotOffset(slot))) {
+    // whatever the slot held before must not be found after a restart
+    releaseSlot(slot);
+    return;
+  }
+
+  std::size_t stale;
+  {
+    std::lock_guard<std::mutex> guard(latch);
+    slots[slot].busy = false;
+    slots[slot].used = true;
+    slots[slot].key = key;
+    // another put of the same page may have finished first; the later write wins
+    std::map<Key, std::size_t>::iterator it = index.find(key);
+    if (it == index.end()) {
+      index.insert(std::make_pair(key, slot));
+      return;
+    }
+    stale = it->second;
+    it->second = slot;
+    slots[stale].used = false;
+    slots[stale].busy = true;
+  }
+  releaseSlot(stale);
+}
+
+bool SecondaryCache::take(const std::string& fileName, const PageId pageNo, char* bytes) {
+  const Key key(fileName, pageNo);
+  std::size_t slot;
+  {
+    std::lock_guard<std::mutex> guard(latch);
+    std::map<Key, std::size_t>::iterator it = index.find(key);
+    if (it == index.end()) {
+      return false;
+    }
+    slot = it->second;
+    index.erase(it);
+    slots[slot].used = false;
+    slots[slot].busy = true;
+  }
+
+  std::vector<char> buffer(SLOT_SIZE);
+  const SlotHeader* header = reinterpret_cast<const SlotHeader*>(buffer.data());
+  const bool good = readFully(fd, buffer.data(), buffer.size(), slotOffset(slot)) &&
+      header->magic == SLOT_MAGIC && header->pageNo == pageNo &&
+      header->nameLength == fileName.size() &&
+      std::memcmp(header->name, fileName.data(), fileName.size()) == 0 &&
+      header->checksum == checksum(buffer.data() + SLOT_HEADER_SIZE);
+  if (good) {
+    std::memcpy(bytes, buffer.data() + SLOT_HEADER_SIZE, Page::SIZE);
+  }
+  // the page now lives in the buffer pool and may change there, so this copy must not be found
+  // again, even after a restart
+  releaseSlot(slot);
+  return good;
+}
+
+void SecondaryCache::drop(const std::string& fileName, const PageId pageNo) {
+  std::size_t slot;
+  {
+    std::lock_guard<std::mutex> guard(latch);
+    std::map<Key, std::size_t>::iterator it = index.find(Key(fileName, pageNo));
+    if (it == index.end()) {
+      return;
+    }
+    slot = it->second;
+    index.erase(it);
+    slots[slot].used = false;
+    slots[slot].busy = true;
+  }
+  releaseSlot(slot);
+}
+
+void SecondaryCache::dropFile(const std::string& fileName) {
+  std::vector<std::size_t> dropped;
+  {
+    std::lock_guard<std::mutex> guard(latch);
+    std::map<Key, std::size_t>::iterator it = index.lower_bound(Key(fileName, 0));
+    while (it != index.end() && it->first.first == fileName) {
+      slots[it->second].used = false;
+      slots[it->second].busy = true;
+      dropped.push_back(it->second);
+      index.erase(it++);
+    }
+  }
+  for (std::size_t i = 0; i < dropped.size(); i++) {
+    releaseSlot(dropped[i]);
+  }
+}
+
+std::size_t SecondaryCache::pages() const {
+  std::lock_guard<std::mutex> guard(latch);
+  return index.size();
+}
+
+}
@@ -0,0 +1,179 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include <sys/types.h>
+
+#include "types.h"
+
+namespace badgerdb {
+
+/**
+ * @brief Second-level page cache kept in a local file, for database files on slower storage.
+ *
+ * The cache file holds a fixed number of slots, each with one page and a header naming the
+ * database file and page number it came from, with a checksum of the page. Reopening the cache
+ * file with the same number of slots finds the pages it held, so the cache survives restarts.
+ * Pages are looked up by file name for the same reason.
+ *
+ * BufMgr stores every page it evicts here and takes pages back out on a miss, so a page is never
+ * both here and in the buffer pool, and every copy here is clean. When every slot is full, the
+ * slots are reused in turn. A copy whose checksum does not match, say after a crash mid-write, is
+ * treated as missing. The cache must be thrown away if the database files are changed by anything
+ * other than a BufMgr using it. Every call is threadsafe; slot I/O is done without the latch held.
+ */
+class SecondaryCache {
+ public:
+  /**
+   * Opens the cache file, or creates it if it is missing or was made with a different number of
+   * slots, in which case it starts out empty.
+   *
+   * @param path      Name of the cache file
+   * @param numSlots  Number of pages the cache file holds
+   * @throws  SecondaryCacheException  If the cache file cannot be opened or sized
+   */
+  SecondaryCache(const std::string& path, const std::size_t numSlots);
+
+  /**
+   * Closes the cache file.
+   */
+  ~SecondaryCache();
+
+  SecondaryCache(const SecondaryCache&) = delete;
+  SecondaryCache& operator=(const SecondaryCache&) = delete;
+
+  /**
+   * Stores a copy of a page, replacing any older copy. Pages of files with names too long for a
+   * slot header are not stored.
+   *
+   * @param fileName  Name of the page's file
+   * @param pageNo    Page number in the file
+   * @param bytes     Page::SIZE bytes of the page
+   */
+  void put(const std::string& fileName, const PageId pageNo, const char* bytes);
+
+  /**
+   * Moves the copy of a page out of the cache, if there is a good one.
+   *
+   * @param fileName  Name of the page's file
+   * @param pageNo    Page number in the file
+   * @param bytes     Page::SIZE bytes the page is read into
+   * @return  False if the cache has no good copy of the page; bytes may have been overwritten
+   */
+  bool take(const std::string& fileName, const PageId pageNo, char* bytes);
+
+  /**
+   * Drops the copy of a page, if there is one.
+   *
+   * @param fileName  Name of the page's file
+   * @param pageNo    Page number in the file
+   */
+  void drop(const std::string& fileName, const PageId pageNo);
+
+  /**
+   * Drops the copies of every page of a file.
+   *
+   * @param fileName  Name of the file
+   */
+  void dropFile(const std::string& fileName);
+
+  /**
+   * Returns the number of pages stored.
+   */
+  std::size_t pages() const;
+
+ private:
+  /**
+   * Identity of a stored page
+   */
+  typedef std::pair<std::string, PageId> Key;
+
+  /**
+   * What the cache knows about one slot
+   */
+  struct Slot {
+    /**
+     * True while the slot holds the page named by key
+     */
+    bool used;
+
+    /**
+     * True while a thread is reading or writing the slot
+     */
+    bool busy;
+
+    /**
+     * Page held by the slot, if used
+     */
+    Key key;
+  };
+
+  /**
+   * Returns the offset of a slot in the cache file.
+   */
+  static off_t slotOffset(const std::size_t slot);
+
+  /**
+   * Finds a slot for a new page: a free one, or the next unbusy one in turn, whose page is
+   * dropped. Caller holds latch.
+   *
+   * @param slot  Chosen slot is returned via this variable
+   * @return  False if every slot is busy
+   */
+  bool claimSlot(std::size_t& slot);
+
+  /**
+   * Marks a slot empty in the cache file and hands it back for reuse. The slot must have been
+   * made busy and taken out of index by the caller, who does not hold latch.
+   */
+  void releaseSlot(const std::size_t slot);
+
+  /**
+   * Name of the cache file
+   */
+  const std::string path;
+
+  /**
+   * Descriptor of the cache file
+   */
+  int fd;
+
+  /**
+   * State of every slot
+   */
+  std::vector<Slot> slots;
+
+  /**
+   * Slots holding no page
+   */
+  std::vector<std::size_t> freeSlots;
+
+  /**
+   * Next slot to reuse when none is free
+   */
+  std::size_t hand;
+
+  /**
+   * Slot holding each stored page
+   */
+  std::map<Key, std::size_t> index;
+
+  /**
+   * Guards all of the above but fd and path
+   */
+  mutable std::mutex latch;
+};
+
+}
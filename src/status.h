@@ -0,0 +1,26 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+namespace badgerdb {
+
+/**
+ * @brief Outcome of the try* calls of Page, File and BufMgr.
+ *
+ * Each names an ordinary outcome that the throwing call of the same name reports with an
+ * exception, so that callers who expect it, such as a loader filling pages until one is full, can
+ * test for it without paying for an exception. Real errors still throw.
+ */
+enum class Status {
+  OK,                  /**< The call did what was asked */
+  INSUFFICIENT_SPACE,  /**< The page has no room for the record; see InsufficientSpaceException */
+  INVALID_PAGE,        /**< The page is not in the file or was deleted; see InvalidPageException */
+  BUFFER_EXCEEDED      /**< Every frame in the pool is pinned; see BufferExceededException */
+};
+
+}
@@ -14,6 +14,11 @@ namespace badgerdb {
  */
 typedef std::uint32_t PageId;
 
+/**
+ * @brief Identifier for an open file, shared by every File object open on it.
+ */
+typedef std::uint32_t FileId;
+
 /**
  * @brief Identifier for a slot in a page.
  */